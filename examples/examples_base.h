@@ -52,6 +52,8 @@ namespace blt::gp::example
         gp_program& get_program() { return program; }
         const gp_program& get_program() const { return program; }
 
+        std::function<bool(const tree_t&, fitness_t&, size_t)>& get_fitness_function() { return fitness_function_ref; }
+
     protected:
         gp_program program;
         selection_t* crossover_sel = nullptr;
@@ -98,8 +98,9 @@ namespace blt::gp::example
         void evaluate_individuals()
         {
             results.clear();
-            for (auto& i : program.get_current_pop().get_individuals())
-                results.emplace_back(test_individual(i), &i);
+            const auto& individuals = program.get_current_pop().get_individuals();
+            for (size_t i = 0; i < individuals.size(); i++)
+                results.emplace_back(test_individual(individuals[i]), i);
             std::sort(results.begin(), results.end(), [](const auto& a, const auto& b)
             {
                 return a.first > b.first;
@@ -126,7 +127,7 @@ namespace blt::gp::example
             for (size_t index = 0; index < amount; index++)
             {
                 const auto& record = results[index].first;
-                const auto& i = *results[index].second;
+                const auto i = program.get_current_pop().get_individual(results[index].second);
 
                 BLT_INFO("Hits %ld, Total Cases %ld, Percent Hit: %lf", record.get_hits(), record.get_total(), record.get_percent_hit());
                 std::cout << record.pretty_print() << std::endl;
@@ -137,13 +138,13 @@ namespace blt::gp::example
             }
         }
 
-        void print_worst(const size_t amount = 3) const
+        void print_worst(const size_t amount = 3)
         {
             BLT_INFO("Worst Results:");
             for (size_t index = 0; index < amount; index++)
             {
                 const auto& record = results[results.size() - 1 - index].first;
-                const auto& i = *results[results.size() - 1 - index].second;
+                const auto i = program.get_current_pop().get_individual(results[results.size() - 1 - index].second);
 
                 BLT_INFO("Hits %ld, Total Cases %ld, Percent Hit: %lf", record.get_hits(), record.get_total(), record.get_percent_hit());
                 std::cout << record.pretty_print() << std::endl;
@@ -173,7 +174,8 @@ namespace blt::gp::example
     private:
         std::vector<rice_record> training_cases;
         std::vector<rice_record> testing_cases;
-        std::vector<std::pair<confusion_matrix_t, individual_t*>> results;
+        // confusion matrix of each individual and its index in the current population
+        std::vector<std::pair<confusion_matrix_t, size_t>> results;
     };
 }
 
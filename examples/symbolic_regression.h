@@ -179,9 +179,8 @@ namespace blt::gp::example
 			const auto best = program.get_best_individuals<3>();
 
 			BLT_INFO("Best approximations:");
-			for (auto& i_ref : best)
+			for (auto& i : best)
 			{
-				auto& i = i_ref.get();
 				BLT_DEBUG("Fitness: {:0.6f}, stand: {:0.6f}, raw: {:0.6f}", i.fitness.adjusted_fitness, i.fitness.standardized_fitness, i.fitness.raw_fitness);
 				i.tree.print(std::cout);
 				std::cout << "\n";
@@ -219,6 +218,12 @@ namespace blt::gp::example
 			return training_cases;
 		}
 
+		// islands of an island model have to evaluate on the same data, see island_model_t
+		void set_training_cases(const std::array<context, 200>& cases)
+		{
+			training_cases = cases;
+		}
+
 	private:
 		std::array<context, 200> training_cases{};
 	};
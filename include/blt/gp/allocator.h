@@ -23,6 +23,8 @@
 #include <blt/logging/logging.h>
 #include <blt/gp/util/trackers.h>
 #include <cstdlib>
+#include <limits>
+#include <new>
 #include <vector>
 
 namespace blt::gp
@@ -34,12 +36,35 @@ namespace blt::gp
 #endif
         static constexpr inline size_t MAX_ALIGNMENT = BLT_GP_MAX_ALIGNMENT;
 
+// alignment of the values stored in a stack_allocator. the packed layout stores values at 4 byte alignment, which halves the size of floats
+// and ints, but rejects types which need more alignment than that, including every type with a drop function.
+#ifndef BLT_GP_VALUE_ALIGNMENT
+#ifdef BLT_GP_PACKED_VALUES
+#define BLT_GP_VALUE_ALIGNMENT 4
+#else
+#define BLT_GP_VALUE_ALIGNMENT BLT_GP_MAX_ALIGNMENT
+#endif
+#endif
+        static constexpr inline size_t VALUE_ALIGNMENT = BLT_GP_VALUE_ALIGNMENT;
+        static_assert(VALUE_ALIGNMENT <= MAX_ALIGNMENT, "Values cannot be aligned to more than the max alignment!");
+        static_assert((VALUE_ALIGNMENT & (VALUE_ALIGNMENT - 1)) == 0, "Value alignment must be a power of two!");
+
+        constexpr size_t align_bytes(const size_t bytes) noexcept
+        {
+            return (bytes + (MAX_ALIGNMENT - 1)) & ~(MAX_ALIGNMENT - 1);
+        }
+
+        constexpr size_t align_value_bytes(const size_t bytes) noexcept
+        {
+            return (bytes + (VALUE_ALIGNMENT - 1)) & ~(VALUE_ALIGNMENT - 1);
+        }
+
 #if BLT_DEBUG_LEVEL > 0
-        static void check_alignment(const size_t bytes, const std::string& message = "Invalid alignment")
+        static void check_alignment(const size_t bytes, const std::string& message = "Invalid alignment", const size_t alignment = MAX_ALIGNMENT)
         {
-            if (bytes % MAX_ALIGNMENT != 0)
+            if (bytes % alignment != 0)
             {
-                BLT_ABORT((message + ", expected multiple of " + std::to_string(detail::MAX_ALIGNMENT) + " got "
+                BLT_ABORT((message + ", expected multiple of " + std::to_string(alignment) + " got "
                     + std::to_string(bytes)).c_str());
             }
         }
@@ -89,8 +114,62 @@ namespace blt::gp
 #endif
             std::free(ptr);
         }
+
+        static size_t usable_size(const size_t bytes)
+        {
+            return bytes;
+        }
+    };
+
+    /**
+     * Default allocator policy. Each thread allocates from its own pool of power of two size classes, which is refilled a slab at a time
+     * from the system allocator. Blocks freed by a thread other than the one which allocated them are pushed onto a lock free list of the
+     * owning pool, which the owner takes back once it runs out of blocks of that size. Requests larger than MAX_CLASS_SIZE go straight to the
+     * system allocator.
+     *
+     * Pools are never destroyed, the pool of an exiting thread is handed to the next thread which needs one, as blocks allocated from it can
+     * outlive the thread.
+     */
+    class slab_allocator_t
+    {
+    public:
+        // every block starts with a pointer to the pool owning it
+        static constexpr size_t HEADER_SIZE = sizeof(void*) > detail::MAX_ALIGNMENT ? sizeof(void*) : detail::MAX_ALIGNMENT;
+        static constexpr size_t MIN_CLASS_SIZE = HEADER_SIZE * 2 > 16 ? HEADER_SIZE * 2 : 16;
+        static constexpr size_t MAX_CLASS_SIZE = 64 * 1024;
+        static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+        struct stats_t
+        {
+            // calls to allocate()
+            u64 allocations = 0;
+            // allocations which went to the system allocator, to refill a slab or for a block larger than MAX_CLASS_SIZE
+            u64 system_allocations = 0;
+            // blocks freed by a thread other than the one which allocated them
+            u64 remote_frees = 0;
+        };
+
+        void* allocate(size_t bytes); // NOLINT
+
+        void deallocate(void* ptr, size_t bytes); // NOLINT
+
+        /**
+         * @return bytes usable in the block returned for a request of bytes, which a container can grow into without reallocating
+         */
+        static size_t usable_size(size_t bytes);
+
+        /**
+         * @return totals over every thread since the program started
+         */
+        static stats_t get_stats();
     };
 
+#ifdef BLT_GP_USE_SYSTEM_ALLOCATOR
+    using allocator_policy_t = aligned_allocator;
+#else
+    using allocator_policy_t = slab_allocator_t;
+#endif
+
     template <typename T>
     class tracked_allocator_t
     {
@@ -111,13 +190,23 @@ namespace blt::gp
             typedef tracked_allocator_t<U> other;
         };
 
+        tracked_allocator_t() = default;
+
+        template <class U>
+        tracked_allocator_t(const tracked_allocator_t<U>&) // NOLINT
+        {
+        }
+
         pointer allocate(size_type n)
         {
 #ifdef BLT_TRACK_ALLOCATIONS
             tracker.allocate(n * sizeof(T));
             //                std::cout << "Hey our tracked allocator allocated " << (n * sizeof(T)) << " bytes!\n";
 #endif
-            return static_cast<pointer>(std::malloc(n * sizeof(T)));
+            if constexpr (alignof(T) > detail::MAX_ALIGNMENT)
+                return static_cast<pointer>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+            else
+                return static_cast<pointer>(allocator_policy_t().allocate(detail::align_bytes(n * sizeof(T))));
         }
 
         pointer allocate(size_type n, const_void_pointer)
@@ -130,10 +219,11 @@ namespace blt::gp
 #ifdef BLT_TRACK_ALLOCATIONS
             ::blt::gp::tracker.deallocate(n * sizeof(T));
             //                std::cout << "[Hey our tracked allocator deallocated " << (n * sizeof(T)) << " bytes!]\n";
-#else
-            (void)n;
 #endif
-            std::free(p);
+            if constexpr (alignof(T) > detail::MAX_ALIGNMENT)
+                ::operator delete(p, std::align_val_t{alignof(T)});
+            else
+                allocator_policy_t().deallocate(p, detail::align_bytes(n * sizeof(T)));
         }
 
         template <class U, class... Args>
@@ -154,25 +244,21 @@ namespace blt::gp
         }
     };
 
+    // stateless, memory allocated by one instance can be freed by any other
     template <class T1, class T2>
-    inline static bool operator==(const tracked_allocator_t<T1>& lhs, const tracked_allocator_t<T2>& rhs) noexcept
+    inline static bool operator==(const tracked_allocator_t<T1>&, const tracked_allocator_t<T2>&) noexcept
     {
-        return &lhs == &rhs;
+        return true;
     }
 
     template <class T1, class T2>
-    inline static bool operator!=(const tracked_allocator_t<T1>& lhs, const tracked_allocator_t<T2>& rhs) noexcept
+    inline static bool operator!=(const tracked_allocator_t<T1>&, const tracked_allocator_t<T2>&) noexcept
     {
-        return &lhs != &rhs;
+        return false;
     }
 
-#ifdef BLT_TRACK_ALLOCATIONS
-    template<typename T>
-    using tracked_vector = std::vector<T, tracked_allocator_t<T>>;
-#else
     template <typename T>
-    using tracked_vector = std::vector<T>;
-#endif
+    using tracked_vector = std::vector<T, tracked_allocator_t<T>>;
 }
 
 #endif //BLT_GP_ALLOCATOR_H
@@ -0,0 +1,156 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_ARENA_H
+#define BLT_GP_ARENA_H
+
+#include <blt/std/types.h>
+#include <blt/gp/allocator.h>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace blt::gp
+{
+    /**
+     * Bump allocator backing every tree of a population, see population_t::enable_arena().
+     *
+     * Memory is never freed individually, instead the whole arena is reset at once when the population is about to be refilled. Blocks are kept
+     * between resets so a population which has reached its working size no longer touches the heap. Each thread leases a region of the arena and
+     * bump allocates from it without locking, so trees written by the same thread end up next to each other in memory.
+     */
+    class tree_arena_t
+    {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+        static constexpr size_t DEFAULT_LEASE_SIZE = 16 * 1024;
+
+        explicit tree_arena_t(size_t block_size = DEFAULT_BLOCK_SIZE, size_t lease_size = DEFAULT_LEASE_SIZE);
+
+        tree_arena_t(const tree_arena_t&) = delete;
+        tree_arena_t& operator=(const tree_arena_t&) = delete;
+
+        ~tree_arena_t();
+
+        /**
+         * Allocates bytes aligned to BLT_GP_MAX_ALIGNMENT. Safe to call from multiple threads at once.
+         */
+        void* allocate(size_t bytes);
+
+        /**
+         * Reclaims every allocation made from this arena. Must not be called while other threads are allocating, and every pointer
+         * previously returned by allocate() is invalid afterwards.
+         */
+        void reset();
+
+        /**
+         * @return total bytes of the blocks owned by this arena
+         */
+        [[nodiscard]] size_t bytes_reserved() const;
+
+        /**
+         * @return bytes handed out to threads since the last reset, including the unused tail of their current leases
+         */
+        [[nodiscard]] size_t bytes_used() const;
+
+    private:
+        struct block_t
+        {
+            u8* data;
+            size_t size;
+        };
+
+        u8* take(size_t bytes);
+
+        mutable std::mutex lock;
+        std::vector<block_t> blocks;
+        size_t current_block = 0;
+        size_t block_offset = 0;
+        size_t used = 0;
+        // changes on every reset, invalidating the leases threads hold on this arena
+        u64 epoch;
+        size_t block_size;
+        size_t lease_size;
+    };
+
+    /**
+     * Allocator used for the operations of a tree. Allocates from the tree's arena when it has one, otherwise from the heap.
+     * Deallocating arena memory does nothing, it is reclaimed by tree_arena_t::reset().
+     */
+    template <typename T>
+    class arena_allocator_t
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        arena_allocator_t() = default;
+
+        explicit arena_allocator_t(tree_arena_t* arena): arena(arena)
+        {
+        }
+
+        template <typename U>
+        arena_allocator_t(const arena_allocator_t<U>& other): arena(other.get_arena()) // NOLINT
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            if (arena != nullptr)
+                return static_cast<T*>(arena->allocate(n * sizeof(T)));
+            return tracked_allocator_t<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (arena == nullptr)
+                tracked_allocator_t<T>{}.deallocate(p, n);
+        }
+
+        [[nodiscard]] tree_arena_t* get_arena() const
+        {
+            return arena;
+        }
+
+        // copies of a vector are temporaries, like the operation stack copied by tree_t::get_depth(), and must not grow the arena
+        [[nodiscard]] arena_allocator_t select_on_container_copy_construction() const
+        {
+            return arena_allocator_t{};
+        }
+
+        template <typename U>
+        friend bool operator==(const arena_allocator_t& lhs, const arena_allocator_t<U>& rhs)
+        {
+            return lhs.arena == rhs.get_arena();
+        }
+
+        template <typename U>
+        friend bool operator!=(const arena_allocator_t& lhs, const arena_allocator_t<U>& rhs)
+        {
+            return lhs.arena != rhs.get_arena();
+        }
+
+    private:
+        tree_arena_t* arena = nullptr;
+    };
+}
+
+#endif //BLT_GP_ARENA_H
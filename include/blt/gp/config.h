@@ -48,13 +48,27 @@ namespace blt::gp
 
         bool try_mutation_on_crossover_failure = true;
 
+        // allocate each population's trees from an arena which is reset every generation instead of from the heap. only used by the generational loop.
+        bool use_tree_arena = false;
+        // let reproduction and elitism share the storage of the parent instead of copying it, until the child is modified. only used by the generational loop.
+        bool use_tree_sharing = false;
+
         std::reference_wrapper<mutation_t> mutator;
         std::reference_wrapper<crossover_t> crossover;
         std::reference_wrapper<population_initializer_t> pop_initializer;
+        // optional pool of pre-generated subtrees, refilled by threads which have finished their share of fitness evaluation
+        subtree_pool_t* subtree_pool = nullptr;
 
         size_t threads = std::thread::hardware_concurrency();
         // number of elements each thread should pull per execution. this is for granularity performance and can be optimized for better results!
         size_t evaluation_size = 4;
+        // split fitness evaluation between threads by the estimated cost of each tree instead of by count. costs are learned by timing every
+        // evaluation, see evaluation_cost_model_t. only used by the generational loop when evaluating with more than one thread. worth
+        // enabling when evaluation cost varies a lot between trees, otherwise the timing costs more than it saves.
+        bool balance_evaluation_cost = false;
+        // evaluate each child as soon as it has been bred, while it is still in cache, instead of evaluating the whole next population after
+        // it has been bred. evaluate_fitness() then only ranks the population and finishes its statistics. only used by the generational loop.
+        bool evaluate_while_breeding = false;
 
         // default config (ramped half-and-half init) or for buildering
         prog_config_t();
@@ -103,6 +117,12 @@ namespace blt::gp
             return *this;
         }
 
+        prog_config_t& set_subtree_pool(subtree_pool_t& pool)
+        {
+            subtree_pool = &pool;
+            return *this;
+        }
+
         prog_config_t& set_elite_count(blt::size_t new_elites)
         {
             elites = new_elites;
@@ -148,6 +168,18 @@ namespace blt::gp
             return *this;
         }
 
+        prog_config_t& set_evaluation_cost_balancing(const bool enabled)
+        {
+            balance_evaluation_cost = enabled;
+            return *this;
+        }
+
+        prog_config_t& set_evaluate_while_breeding(const bool enabled)
+        {
+            evaluate_while_breeding = enabled;
+            return *this;
+        }
+
         prog_config_t& set_max_tree_depth(const size_t depth)
         {
             max_tree_depth = depth;
@@ -159,6 +191,18 @@ namespace blt::gp
             reproduction_chance = chance;
             return *this;
         }
+
+        prog_config_t& set_tree_arena(const bool enabled)
+        {
+            use_tree_arena = enabled;
+            return *this;
+        }
+
+        prog_config_t& set_tree_sharing(const bool enabled)
+        {
+            use_tree_sharing = enabled;
+            return *this;
+        }
     };
 }
 
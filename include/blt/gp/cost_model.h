@@ -0,0 +1,76 @@
+#pragma once
+/*
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_COST_MODEL_H
+#define BLT_GP_COST_MODEL_H
+
+#include <blt/gp/fwdecl.h>
+#include <blt/gp/tree.h>
+
+namespace blt::gp
+{
+    /**
+     * Estimates how long the fitness function takes to evaluate a tree, as a fixed cost per tree plus a cost per operator in it.
+     * Every operator starts at the same cost, so until the model has been fit the estimate is proportional to the size of the tree.
+     *
+     * fit() learns the costs from measured evaluation times. Each measured time is split between the tree and its operators in proportion to
+     * their current costs, and every cost moves towards the average share it was given.
+     */
+    class evaluation_cost_model_t
+    {
+    public:
+        // number of measured trees used by each call to fit(), spread evenly over the population
+        static constexpr size_t SAMPLES_PER_FIT = 512;
+
+        [[nodiscard]] double estimate(const tree_t& tree) const
+        {
+            double cost = tree_cost;
+            for (size_t i = 0; i < tree.size(); i++)
+            {
+                const auto id = static_cast<size_t>(tree.get_operator(i).id());
+                cost += id < operator_costs.size() ? operator_costs[id] : 1;
+            }
+            return cost;
+        }
+
+        /**
+         * @param population individuals which have been evaluated
+         * @param estimates estimate() of every individual, made before it was evaluated
+         * @param times measured evaluation time of every individual, in nanoseconds
+         */
+        void fit(const population_t& population, const tracked_vector<double>& estimates, const tracked_vector<double>& times);
+
+        [[nodiscard]] double get_tree_cost() const
+        {
+            return tree_cost;
+        }
+
+        [[nodiscard]] const tracked_vector<double>& get_operator_costs() const
+        {
+            return operator_costs;
+        }
+
+    private:
+        double tree_cost = 1;
+        tracked_vector<double> operator_costs;
+        tracked_vector<double> share_sums;
+        tracked_vector<size_t> share_counts;
+    };
+}
+
+#endif //BLT_GP_COST_MODEL_H
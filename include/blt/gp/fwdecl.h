@@ -24,7 +24,16 @@
 #include <blt/std/types.h>
 #include <ostream>
 #include <blt/gp/util/trackers.h>
+#include <blt/gp/util/callable.h>
+#include <blt/gp/util/small_vector.h>
 #include <blt/gp/allocator.h>
+#include <blt/gp/arena.h>
+
+#ifndef BLT_GP_INLINE_OPERATIONS
+// number of operators a tree stores inside itself before allocating. off by default, the space is paid for by every individual of a
+// population while only the smallest trees fit. use together with BLT_GP_INLINE_STACK_BYTES, for example 16 and 48
+#define BLT_GP_INLINE_OPERATIONS 0
+#endif
 
 namespace blt::gp
 {
@@ -56,19 +65,24 @@ namespace blt::gp
     
     class full_generator_t;
     
+    class subtree_pool_t;
+    
     class stack_allocator;
     
     template<typename T>
     class tracked_allocator_t;
 
+    // operations of a tree, allocated from the tree's arena if it has one. small trees can keep them inline, see BLT_GP_INLINE_OPERATIONS
+    using op_vector_t = small_vector_t<op_container_t, BLT_GP_INLINE_OPERATIONS, arena_allocator_t<op_container_t>>;
+
     namespace detail
     {
         class operator_storage_test;
         // context*, read stack, write stack
-        using operator_func_t = std::function<void(void*, stack_allocator&, stack_allocator&)>;
-        using eval_func_t = std::function<evaluation_context&(const tree_t& tree, void* context)>;
+        using operator_func_t = callable_t<void(void*, stack_allocator&, stack_allocator&)>;
+        using eval_func_t = callable_t<evaluation_context&(const tree_t& tree, void* context)>;
         // debug function,
-        using print_func_t = std::function<void(std::ostream&, stack_allocator&)>;
+        using print_func_t = callable_t<void(std::ostream&, stack_allocator&)>;
         
         enum class destroy_t
         {
@@ -76,10 +90,10 @@ namespace blt::gp
             RETURN
         };
         
-        using destroy_func_t = std::function<void(destroy_t, u8*)>;
+        using destroy_func_t = callable_t<void(destroy_t, u8*)>;
         
-        using const_op_iter_t = tracked_vector<op_container_t>::const_iterator;
-        using op_iter_t = tracked_vector<op_container_t>::iterator;
+        using const_op_iter_t = const op_container_t*;
+        using op_iter_t = op_container_t*;
     }
 
 #if BLT_DEBUG_LEVEL > 0
@@ -21,6 +21,7 @@
 
 #include <blt/gp/fwdecl.h>
 #include <blt/gp/tree.h>
+#include <vector>
 
 namespace blt::gp
 {
@@ -68,12 +69,68 @@ namespace blt::gp
             void generate(tree_t& out, const generator_arguments& args) final;
     };
     
+    /**
+     * Probabilistic tree creation (PTC2). Instead of controlling the depth of the tree this generator picks a target number of nodes,
+     * then expands randomly selected open argument slots with non-terminals until the target is reached, filling any remaining slots with terminals.
+     * Trees produced are within a few nodes of the target size (operators can add more than one slot at a time), in linear time.
+     * The max depth in the generator arguments is still respected, min depth is not used.
+     */
+    class ptc2_generator_t : public tree_generator_t
+    {
+        public:
+            /**
+             * Target sizes are selected uniformly from [min_size, max_size]
+             */
+            ptc2_generator_t(size_t min_size, size_t max_size);
+            
+            /**
+             * Target sizes are selected from the provided distribution, size_weights[i] is the relative chance of generating a tree with i + 1 nodes
+             */
+            explicit ptc2_generator_t(const std::vector<double>& size_weights);
+            
+            void generate(tree_t& out, const generator_arguments& args) final;
+        
+        private:
+            [[nodiscard]] size_t select_size(gp_program& program) const;
+            
+            size_t min_size = 1;
+            size_t max_size = 1;
+            // cumulative probability of each size, starting at a size of 1. empty when sizes are uniform.
+            std::vector<double> size_distribution;
+    };
+    
     class population_initializer_t
     {
         public:
             virtual population_t generate(const initializer_arguments& args) = 0;
             
+            /**
+             * If enabled, structurally identical trees (see tree_t::structural_hash) are regenerated after the population has been created.
+             */
+            population_initializer_t& set_remove_duplicates(const bool remove)
+            {
+                remove_duplicates = remove;
+                return *this;
+            }
+            
+            // number of times we will try to regenerate a duplicate tree before accepting it as is
+            population_initializer_t& set_max_duplicate_retries(const size_t retries)
+            {
+                max_duplicate_retries = retries;
+                return *this;
+            }
+            
             virtual ~population_initializer_t() = default;
+        
+        protected:
+            /**
+             * Creates a population of args.size trees, generated in place using all threads available to the program.
+             * generate_tree is called with an empty tree and the index of the individual it will become and must be thread safe.
+             */
+            population_t generate_population(const initializer_arguments& args, const std::function<void(tree_t&, size_t)>& generate_tree) const;
+            
+            bool remove_duplicates = false;
+            size_t max_duplicate_retries = 5;
     };
     
     class grow_initializer_t : public population_initializer_t
@@ -104,6 +161,23 @@ namespace blt::gp
             full_generator_t full;
     };
     
+    class ptc2_initializer_t : public population_initializer_t
+    {
+        public:
+            ptc2_initializer_t(const size_t min_size, const size_t max_size): ptc2(min_size, max_size)
+            {
+            }
+            
+            explicit ptc2_initializer_t(const std::vector<double>& size_weights): ptc2(size_weights)
+            {
+            }
+            
+            population_t generate(const initializer_arguments& args) final;
+        
+        private:
+            ptc2_generator_t ptc2;
+    };
+    
     class ramped_half_initializer_t : public population_initializer_t
     {
         public:
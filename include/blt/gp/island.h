@@ -0,0 +1,233 @@
+#pragma once
+/*
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_ISLAND_H
+#define BLT_GP_ISLAND_H
+
+#include <blt/gp/fwdecl.h>
+#include <blt/gp/tree.h>
+#include <blt/meta/config_generator.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace blt::gp
+{
+    /**
+     * Evolves several programs (islands) side by side, each with its own population and worker threads, and periodically copies individuals
+     * between them. Islands never wait on each other, so the threads of one island only synchronise with the threads of the same island. Give
+     * each island a share of the cores with prog_config_t::set_thread_count().
+     *
+     * Every migration_interval generations an island sends copies of its emigrants to each of its neighbours in the topology, then replaces
+     * individuals of its own population with whatever migrants have arrived since its last migration. Migrants travel through a bounded single
+     * producer single consumer queue per pair of neighbours. If an island falls behind and its queue fills up, newer migrants are dropped
+     * instead of blocking the sender.
+     *
+     * The islands must be fully set up (initial population generated and an evaluation setup called) before run(), must have been built from the
+     * same operators, and must use the same fitness function, as migrants keep the fitness they were given on their home island.
+     * Like the mutation and crossover operators, the programs must outlive the island model.
+     */
+    class island_model_t
+    {
+    public:
+        enum class topology_t : u8
+        {
+            // island i sends to island i + 1, the last island to the first
+            RING,
+            // islands are laid out on a grid which wraps around at the edges, each sends to the islands above, below, left and right of it
+            TORUS,
+            // every island sends to every other island
+            FULLY_CONNECTED
+        };
+
+        enum class emigrant_policy_t : u8
+        {
+            // the fittest individuals of the island are sent
+            BEST,
+            // individuals are picked uniformly at random
+            RANDOM
+        };
+
+        enum class replacement_policy_t : u8
+        {
+            // migrants replace the least fit individuals of the receiving island
+            WORST,
+            // migrants replace individuals picked uniformly at random, never the elites
+            RANDOM
+        };
+
+        struct config_t
+        {
+            topology_t topology = topology_t::RING;
+            emigrant_policy_t emigrant_policy = emigrant_policy_t::BEST;
+            replacement_policy_t replacement_policy = replacement_policy_t::WORST;
+            // generations between migrations. zero disables migration
+            size_t migration_interval = 10;
+            // individuals sent to each neighbour per migration
+            size_t migrants = 5;
+            // migrations a queue can hold before migrants are dropped
+            size_t queued_migrations = 2;
+            // columns of the torus. zero picks the largest divisor of the island count which is not larger than its square root
+            size_t torus_width = 0;
+
+            BLT_MAKE_SETTER_LVALUE(topology_t, topology);
+            BLT_MAKE_SETTER_LVALUE(emigrant_policy_t, emigrant_policy);
+            BLT_MAKE_SETTER_LVALUE(replacement_policy_t, replacement_policy);
+            BLT_MAKE_SETTER_LVALUE(size_t, migration_interval);
+            BLT_MAKE_SETTER_LVALUE(size_t, migrants);
+            BLT_MAKE_SETTER_LVALUE(size_t, queued_migrations);
+            BLT_MAKE_SETTER_LVALUE(size_t, torus_width);
+        };
+
+        struct migrant_t
+        {
+            tree_t tree;
+            fitness_t fitness;
+
+            explicit migrant_t(gp_program& program): tree(program)
+            {
+            }
+        };
+
+        /**
+         * Lock free queue of migrants from one island to another. Only the sending island pushes and only the receiving island pops. The trees
+         * belong to the receiving program and are reused, so migrants are copied in and out with tree_t::copy_fast().
+         */
+        class migration_queue_t
+        {
+        public:
+            migration_queue_t(gp_program& destination, size_t capacity);
+
+            /**
+             * @return the next free slot, or nullptr if the queue is full. The slot is only visible to the receiver after push().
+             */
+            [[nodiscard]] migrant_t* back()
+            {
+                const auto tail = m_tail.load(std::memory_order_relaxed);
+                if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+                    return nullptr;
+                return &m_slots[tail % m_slots.size()];
+            }
+
+            void push()
+            {
+                m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            /**
+             * @return the oldest migrant, or nullptr if the queue is empty. The slot stays valid until pop().
+             */
+            [[nodiscard]] migrant_t* front()
+            {
+                const auto head = m_head.load(std::memory_order_relaxed);
+                if (head == m_tail.load(std::memory_order_acquire))
+                    return nullptr;
+                return &m_slots[head % m_slots.size()];
+            }
+
+            void pop()
+            {
+                m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            [[nodiscard]] size_t size() const
+            {
+                return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+            }
+
+        private:
+            std::vector<migrant_t> m_slots;
+            // only written by the receiver
+            alignas(64) std::atomic_size_t m_head = 0;
+            // only written by the sender
+            alignas(64) std::atomic_size_t m_tail = 0;
+        };
+
+        island_model_t(std::vector<gp_program*> islands, const config_t& config);
+
+        /**
+         * Evolves every island until it reaches its termination condition. Island 0 runs on the calling thread, every other island on a thread
+         * of its own which drives the island's program like a main thread would. on_generation is called after each generation of an island,
+         * from the thread running that island, so it may be called for several islands at once.
+         */
+        void run(const std::function<void(size_t island, gp_program& program)>& on_generation = {});
+
+        /**
+         * Sends migrants from the island to its neighbours and receives the migrants waiting for it. Called by run() every migration_interval
+         * generations, it can also be called directly when driving the islands manually. Must be called from the thread driving the island,
+         * between generations.
+         */
+        void migrate(size_t island);
+
+        [[nodiscard]] size_t size() const
+        {
+            return m_islands.size();
+        }
+
+        [[nodiscard]] gp_program& get_island(const size_t island) const
+        {
+            return *m_islands[island];
+        }
+
+        /**
+         * @return index of the island holding the fittest individual. Only meaningful while no island is evolving.
+         */
+        [[nodiscard]] size_t get_best_island() const;
+
+        [[nodiscard]] const std::vector<size_t>& get_neighbours(const size_t island) const
+        {
+            return m_neighbours[island];
+        }
+
+        /**
+         * @return migrants received by the island so far
+         */
+        [[nodiscard]] size_t get_immigrants(const size_t island) const
+        {
+            return m_immigrants[island].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return migrants which could not be sent to the island because its queue was full
+         */
+        [[nodiscard]] size_t get_dropped_migrants(const size_t island) const
+        {
+            return m_dropped[island].load(std::memory_order_relaxed);
+        }
+
+    private:
+        void build_topology();
+
+        void emigrate(size_t island);
+
+        void immigrate(size_t island);
+
+        std::vector<gp_program*> m_islands;
+        config_t m_config;
+        std::vector<std::vector<size_t>> m_neighbours;
+        // queues of migrants into each island, one per island sending to it
+        std::vector<std::vector<std::unique_ptr<migration_queue_t>>> m_incoming;
+        // queue of each neighbour of an island which the island writes to, in the same order as m_neighbours
+        std::vector<std::vector<migration_queue_t*>> m_outgoing;
+        std::unique_ptr<std::atomic_size_t[]> m_immigrants;
+        std::unique_ptr<std::atomic_size_t[]> m_dropped;
+    };
+}
+
+#endif //BLT_GP_ISLAND_H
@@ -0,0 +1,379 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_LINEAR_H
+#define BLT_GP_LINEAR_H
+
+#include <blt/gp/fwdecl.h>
+#include <blt/gp/typesystem.h>
+#include <blt/gp/tree.h>
+#include <blt/gp/util/statistics.h>
+#include <blt/meta/config_generator.h>
+#include <array>
+#include <atomic>
+#include <ostream>
+
+namespace blt::gp
+{
+    /**
+     * Register layout shared by every linear program of a population. Each type used by the program's operators gets its own bank of registers.
+     * Register 0 of the output type holds the result of the program.
+     */
+    struct linear_layout_t
+    {
+        type_id output_type;
+        size_t registers_per_type = 0;
+        // indexed by type id, byte offset of the type's register bank
+        tracked_vector<size_t> bank_offsets;
+        // indexed by type id, size of a single register
+        tracked_vector<size_t> register_sizes;
+        // types which have at least one operator returning them
+        tracked_vector<type_id> usable_types;
+        size_t total_bytes = 0;
+
+        linear_layout_t() = default;
+
+        linear_layout_t(gp_program& program, type_id output_type, size_t registers_per_type);
+
+        [[nodiscard]] size_t register_offset(const type_id type, const size_t index) const
+        {
+            return bank_offsets[type] + index * register_sizes[type];
+        }
+    };
+
+    /**
+     * Linear genetic programming representation. A program is a sequence of register machine instructions, each of which
+     * applies one of the operators registered with the gp_program (through operator_builder) to a set of typed registers.
+     *
+     * Types used in linear programs must be valid when zero initialized as registers start zeroed. Types with drop functions are not supported,
+     * as registers can be read any number of times.
+     */
+    class linear_program_t
+    {
+    public:
+        // maximum number of non-context arguments an operator can have to be used in a linear program
+        static constexpr size_t max_arguments = 4;
+        // maximum size of an ephemeral constant, which is stored inline with the instruction
+        static constexpr size_t max_constant_bytes = 16;
+
+        struct instruction_t
+        {
+            operator_id id;
+            u16 destination;
+            u16 argc;
+            std::array<u16, max_arguments> arguments;
+            alignas(detail::MAX_ALIGNMENT) std::array<u8, max_constant_bytes> constant;
+        };
+
+        linear_program_t(gp_program& program, const linear_layout_t& layout): m_program(&program), m_layout(&layout)
+        {
+        }
+
+        /**
+         * Replaces the contents of this program with length random instructions
+         */
+        void generate(size_t length);
+
+        /**
+         * @return a new random instruction. Terminals are selected with a chance of terminal_chance.
+         */
+        [[nodiscard]] instruction_t random_instruction(double terminal_chance = 0.3) const;
+
+        void randomize_registers(instruction_t& instruction) const;
+
+        /**
+         * Must be called after instructions have been modified. Finds the instructions which contribute to the output register,
+         * everything else is skipped during evaluation.
+         */
+        void update_effective();
+
+        template <typename T, typename Context>
+        T get_evaluation_value(const Context& context) const
+        {
+            return *reinterpret_cast<const T*>(execute(const_cast<void*>(static_cast<const void*>(&context))) +
+                m_layout->register_offset(m_layout->output_type, 0));
+        }
+
+        template <typename T>
+        T get_evaluation_value() const
+        {
+            return *reinterpret_cast<const T*>(execute(nullptr) + m_layout->register_offset(m_layout->output_type, 0));
+        }
+
+        void print(std::ostream& out, bool only_effective = false) const;
+
+        [[nodiscard]] size_t size() const
+        {
+            return instructions.size();
+        }
+
+        [[nodiscard]] size_t effective_size() const
+        {
+            return effective.size();
+        }
+
+        [[nodiscard]] tracked_vector<instruction_t>& get_instructions()
+        {
+            return instructions;
+        }
+
+        [[nodiscard]] const tracked_vector<instruction_t>& get_instructions() const
+        {
+            return instructions;
+        }
+
+        [[nodiscard]] const tracked_vector<u32>& get_effective() const
+        {
+            return effective;
+        }
+
+        [[nodiscard]] gp_program& get_program() const
+        {
+            return *m_program;
+        }
+
+        [[nodiscard]] const linear_layout_t& get_layout() const
+        {
+            return *m_layout;
+        }
+
+    private:
+        // returns the thread local register file after executing the program
+        [[nodiscard]] const u8* execute(void* context) const;
+
+        tracked_vector<instruction_t> instructions;
+        // indexes of instructions which contribute to the output, in execution order
+        tracked_vector<u32> effective;
+        gp_program* m_program;
+        const linear_layout_t* m_layout;
+    };
+
+    struct linear_individual_t
+    {
+        linear_program_t program;
+        fitness_t fitness;
+    };
+
+    class linear_crossover_t
+    {
+    public:
+        struct config_t
+        {
+            // largest segment which will be exchanged between parents
+            size_t max_segment_length = 8;
+            // programs will not be made smaller or larger than these bounds
+            size_t min_program_length = 1;
+            size_t max_program_length = 128;
+
+            BLT_MAKE_SETTER_LVALUE(size_t, max_segment_length);
+            BLT_MAKE_SETTER_LVALUE(size_t, min_program_length);
+            BLT_MAKE_SETTER_LVALUE(size_t, max_program_length);
+        };
+
+        linear_crossover_t() = default;
+
+        explicit linear_crossover_t(const config_t& config): config(config)
+        {
+        }
+
+        /**
+         * Two point linear crossover, exchanges a random segment of p1 with a random segment of p2.
+         * c1 and c2 are expected to be copies of p1 and p2.
+         */
+        virtual bool apply(gp_program& program, const linear_program_t& p1, const linear_program_t& p2, linear_program_t& c1, linear_program_t& c2);
+
+        virtual ~linear_crossover_t() = default;
+
+    protected:
+        config_t config;
+    };
+
+    class linear_mutation_t
+    {
+    public:
+        struct config_t
+        {
+            // chance of inserting or deleting an instruction, otherwise a single instruction is modified
+            double macro_mutation_chance = 0.5;
+            // chance an inserted instruction or replacement operator is a terminal
+            double terminal_chance = 0.3;
+            size_t min_program_length = 1;
+            size_t max_program_length = 128;
+
+            BLT_MAKE_SETTER_LVALUE(double, macro_mutation_chance);
+            BLT_MAKE_SETTER_LVALUE(double, terminal_chance);
+            BLT_MAKE_SETTER_LVALUE(size_t, min_program_length);
+            BLT_MAKE_SETTER_LVALUE(size_t, max_program_length);
+        };
+
+        linear_mutation_t() = default;
+
+        explicit linear_mutation_t(const config_t& config): config(config)
+        {
+        }
+
+        /**
+         * Mutates c, which is expected to be a copy of p. Prefers mutating effective instructions.
+         */
+        virtual bool apply(gp_program& program, const linear_program_t& p, linear_program_t& c);
+
+        virtual ~linear_mutation_t() = default;
+
+    protected:
+        config_t config;
+    };
+
+    /**
+     * Evolves a population of linear programs using the operators, random engine, threads and config (population size, generations,
+     * operator chances and elites) of the provided gp_program. The gp_program should not also be used for tree evaluation, as its worker
+     * threads are used for evaluating and breeding linear programs.
+     */
+    class linear_gp_t
+    {
+    public:
+        struct config_t
+        {
+            size_t registers_per_type = 8;
+            size_t initial_min_length = 8;
+            size_t initial_max_length = 32;
+            size_t tournament_size = 3;
+
+            std::reference_wrapper<linear_crossover_t> crossover;
+            std::reference_wrapper<linear_mutation_t> mutator;
+
+            BLT_MAKE_SETTER_LVALUE(size_t, registers_per_type);
+            BLT_MAKE_SETTER_LVALUE(size_t, initial_min_length);
+            BLT_MAKE_SETTER_LVALUE(size_t, initial_max_length);
+            BLT_MAKE_SETTER_LVALUE(size_t, tournament_size);
+
+            config_t& set_crossover(linear_crossover_t& ref)
+            {
+                crossover = ref;
+                return *this;
+            }
+
+            config_t& set_mutation(linear_mutation_t& ref)
+            {
+                mutator = ref;
+                return *this;
+            }
+
+            config_t();
+        };
+
+        explicit linear_gp_t(gp_program& program, const config_t& config = config_t{}): program(program), config(config)
+        {
+        }
+
+        void generate_initial_population(type_id output_type);
+
+        /**
+         * Evaluates every individual using fitness_function(const linear_program_t&, fitness_t&, size_t index), which can return a bool
+         * (true meaning a solution was found) or nothing.
+         */
+        template <typename FitnessFunc>
+        void evaluate_fitness(FitnessFunc& fitness_function)
+        {
+            using LambdaReturn = std::invoke_result_t<decltype(fitness_function), const linear_program_t&, fitness_t&, size_t>;
+            statistic_history.push_back(current_stats);
+            current_stats.clear();
+            std::atomic_uint64_t next_index = 0;
+            execute_chunked([&](const size_t begin, const size_t end) {
+                double overall = 0;
+                for (size_t i = begin; i < end; i++)
+                {
+                    auto& ind = current_pop[i];
+                    ind.fitness = {};
+                    if constexpr (std::is_same_v<LambdaReturn, bool> || std::is_convertible_v<LambdaReturn, bool>)
+                    {
+                        if (fitness_function(ind.program, ind.fitness, i))
+                            fitness_should_exit = true;
+                    } else
+                        fitness_function(ind.program, ind.fitness, i);
+                    overall += ind.fitness.adjusted_fitness;
+                }
+                auto old = current_stats.overall_fitness.load(std::memory_order_relaxed);
+                while (!current_stats.overall_fitness.compare_exchange_weak(old, old + overall, std::memory_order_relaxed,
+                                                                            std::memory_order_relaxed))
+                {
+                }
+            }, next_index);
+            update_stats();
+        }
+
+        void create_next_generation();
+
+        void next_generation()
+        {
+            std::swap(current_pop, next_pop);
+            ++current_generation;
+        }
+
+        [[nodiscard]] bool should_terminate() const;
+
+        [[nodiscard]] const linear_individual_t& get_best_individual() const;
+
+        [[nodiscard]] const population_stats& get_population_stats() const
+        {
+            return current_stats;
+        }
+
+        [[nodiscard]] const tracked_vector<population_stats>& get_stats_history() const
+        {
+            return statistic_history;
+        }
+
+        [[nodiscard]] tracked_vector<linear_individual_t>& get_current_pop()
+        {
+            return current_pop;
+        }
+
+        [[nodiscard]] const linear_layout_t& get_layout() const
+        {
+            return layout;
+        }
+
+        [[nodiscard]] size_t get_current_generation() const
+        {
+            return current_generation;
+        }
+
+    private:
+        // runs func(begin, end) over the population on all of the program's threads
+        void execute_chunked(const std::function<void(size_t, size_t)>& func, std::atomic_uint64_t& next_index) const;
+
+        void update_stats();
+
+        [[nodiscard]] const linear_program_t& select() const;
+
+        gp_program& program;
+        config_t config;
+        linear_layout_t layout;
+
+        tracked_vector<linear_individual_t> current_pop;
+        tracked_vector<linear_individual_t> next_pop;
+
+        population_stats current_stats;
+        tracked_vector<population_stats> statistic_history;
+
+        size_t current_generation = 0;
+        std::atomic_bool fitness_should_exit = false;
+    };
+}
+
+#endif //BLT_GP_LINEAR_H
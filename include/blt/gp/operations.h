@@ -163,18 +163,22 @@ namespace blt::gp
         template <typename Context>
         [[nodiscard]] detail::operator_func_t make_callable() const
         {
-            return [this](void* context, stack_allocator& read_allocator, stack_allocator& write_allocator)
-            {
-                if constexpr (detail::is_same_v<Context, detail::remove_cv_ref<typename detail::first_arg<Args...>::type>>)
-                {
-                    // first arg is context
-                    write_allocator.push(this->operator()(context, read_allocator));
-                }
-                else
+            return {
+                [](const void* data, void* context, stack_allocator& read_allocator, stack_allocator& write_allocator)
                 {
-                    // first arg isn't context
-                    write_allocator.push(this->operator()(read_allocator));
-                }
+                    const auto& op = *static_cast<const operation_t*>(data);
+                    if constexpr (detail::is_same_v<Context, detail::remove_cv_ref<typename detail::first_arg<Args...>::type>>)
+                    {
+                        // first arg is context
+                        write_allocator.push(op(context, read_allocator));
+                    }
+                    else
+                    {
+                        // first arg isn't context
+                        write_allocator.push(op(read_allocator));
+                    }
+                },
+                this
             };
         }
 
@@ -199,6 +203,21 @@ namespace blt::gp
             return is_ephemeral_;
         }
 
+        /**
+         * Sets the relative chance of this operator being selected compared to other operators with the same return type.
+         * Defaults to 1. Useful for making expensive operators less likely to appear in generated trees.
+         */
+        auto set_weight(const double weight)
+        {
+            weight_ = weight;
+            return *this;
+        }
+
+        [[nodiscard]] double get_weight() const
+        {
+            return weight_;
+        }
+
         [[nodiscard]] bool return_has_ephemeral_drop() const
         {
             return detail::has_func_drop_v<detail::remove_cv_ref<Return>>;
@@ -210,6 +229,7 @@ namespace blt::gp
         function_t func;
         std::optional<std::string_view> name;
         bool is_ephemeral_ = false;
+        double weight_ = 1.0;
     };
 
     template <typename RawFunction, typename Return, typename Class, typename... Args>
@@ -32,6 +32,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <stdexcept>
 
@@ -46,12 +47,15 @@
 #include <blt/gp/typesystem.h>
 #include <blt/gp/operations.h>
 #include <blt/gp/transformers.h>
+#include <blt/gp/subtree_pool.h>
 #include <blt/gp/selection.h>
 #include <blt/gp/tree.h>
 #include <blt/gp/stack.h>
 #include <blt/gp/config.h>
 #include <blt/gp/random.h>
 #include <blt/gp/threading.h>
+#include <blt/gp/cost_model.h>
+#include <blt/gp/util/alias_table.h>
 #include "blt/format/format.h"
 
 namespace blt::gp
@@ -237,20 +241,69 @@ namespace errors::serialization
 		argc_t argc{};
 	};
 
+	/**
+	 * Dense copy of the operator properties read per node by the tree structural operations (traversal, subtree selection, generation, printing),
+	 * indexed from OPERATOR ID. operator_info_t holds the same information but reading it pulls in the operator callable and a heap allocated vector.
+	 */
+	struct operator_table_t
+	{
+		// number of non-context arguments
+		tracked_vector<u32> argc;
+		tracked_vector<type_id> return_types;
+		// aligned size of the return type, the number of bytes a value produced by this operator takes on the stack
+		tracked_vector<u32> return_sizes;
+		tracked_vector<operator_special_flags> flags;
+		// argument types of operator i are stored in argument_types[argument_offsets[i], argument_offsets[i + 1])
+		tracked_vector<u32> argument_offsets;
+		tracked_vector<type_id> argument_types;
+
+		void add(const operator_info_t& info, const size_t return_size, const operator_special_flags op_flags)
+		{
+			if (argument_offsets.empty())
+				argument_offsets.push_back(0);
+			argc.push_back(info.argc.argc);
+			return_types.push_back(info.return_type);
+			return_sizes.push_back(static_cast<u32>(return_size));
+			flags.push_back(op_flags);
+			argument_types.insert(argument_types.end(), info.argument_types.begin(), info.argument_types.end());
+			argument_offsets.push_back(static_cast<u32>(argument_types.size()));
+		}
+
+		[[nodiscard]] bool is_terminal(const operator_id id) const
+		{
+			return argc[id] == 0;
+		}
+
+		[[nodiscard]] const type_id* arguments_begin(const operator_id id) const
+		{
+			return argument_types.data() + argument_offsets[id];
+		}
+
+		[[nodiscard]] const type_id* arguments_end(const operator_id id) const
+		{
+			return argument_types.data() + argument_offsets[static_cast<size_t>(id) + 1];
+		}
+	};
+
 	struct program_operator_storage_t
 	{
 		// indexed from return TYPE ID, returns index of operator
 		expanding_buffer<tracked_vector<operator_id>> terminals;
 		expanding_buffer<tracked_vector<operator_id>> non_terminals;
 		expanding_buffer<tracked_vector<std::pair<operator_id, size_t>>> operators_ordered_terminals;
-		// indexed from OPERATOR ID (operator number) to a bitfield of flags
-		hashmap_t<operator_id, operator_special_flags> operator_flags;
+		// weighted selection tables built from the lists above, indexed from return TYPE ID
+		expanding_buffer<alias_table_t> terminal_tables;
+		expanding_buffer<alias_table_t> non_terminal_tables;
+		expanding_buffer<alias_table_t> ordered_terminal_tables;
 
 		tracked_vector<operator_info_t> operators;
+		operator_table_t operator_table;
 		tracked_vector<operator_metadata_t> operator_metadata;
 		tracked_vector<detail::print_func_t> print_funcs;
 		tracked_vector<detail::destroy_func_t> destroy_funcs;
 		tracked_vector<std::optional<std::string_view>> names;
+		// indexed from OPERATOR ID, relative selection weight of the operator
+		tracked_vector<double> weights;
 
 		detail::eval_func_t eval_func;
 
@@ -280,7 +333,7 @@ namespace errors::serialization
 			//                largest = largest * largest_argc;
 			size_t largest = largest_args * largest_argc * largest_returns * largest_argc;
 
-			storage.eval_func = tree_t::make_execution_lambda<Context>(largest, operators...);
+			storage.eval_func = detail::eval_func_t::make(tree_t::make_execution_lambda<Context>(largest, operators...));
 
 			blt::hashset_t<type_id> has_terminals;
 
@@ -340,6 +393,18 @@ namespace errors::serialization
 				storage.operators_ordered_terminals[return_type] = ordered_terminals;
 			}
 
+			for (const auto& [index, value] : blt::enumerate(storage.terminals))
+				storage.terminal_tables[index].build(value, storage.weights);
+			for (const auto& [index, value] : blt::enumerate(storage.non_terminals))
+				storage.non_terminal_tables[index].build(value, storage.weights);
+			for (const auto& [index, value] : blt::enumerate(storage.operators_ordered_terminals))
+			{
+				tracked_vector<operator_id> ops;
+				for (const auto& [op, _] : value)
+					ops.push_back(op);
+				storage.ordered_terminal_tables[index].build(ops, storage.weights);
+			}
+
 			return storage;
 		}
 
@@ -359,6 +424,8 @@ namespace errors::serialization
 			auto return_type_id = storage.system.get_type<Return>().id();
 			auto operator_id = blt::gp::operator_id(storage.operators.size());
 			op.id = operator_id;
+			BLT_ASSERT(storage.operators.size() < op_container_t::max_operators && "Too many operators registered!");
+			BLT_ASSERT(stack_allocator::aligned_size<Return>() <= op_container_t::max_type_size && "Return type is too large to be stored in a tree!");
 
 			operator_info_t info;
 
@@ -389,7 +456,9 @@ namespace errors::serialization
 			meta.argc = info.argc;
 
 			storage.operator_metadata.push_back(meta);
-			storage.print_funcs.push_back([&op](std::ostream& out, stack_allocator& stack) {
+			using operation_type = operation_t<RawFunction, Return(Args...)>;
+			storage.print_funcs.emplace_back([](const void* data, std::ostream& out, stack_allocator& stack) {
+				const auto& op = *static_cast<const operation_type*>(data);
 				if constexpr (blt::meta::is_streamable_v<Return>)
 				{
 					out << stack.from<Return>(0);
@@ -398,8 +467,8 @@ namespace errors::serialization
 				{
 					out << "[Printing Value on '" << (op.get_name() ? *op.get_name() : "") << "' Not Supported!]";
 				}
-			});
-			storage.destroy_funcs.push_back([](const detail::destroy_t type, u8* data) {
+			}, &op);
+			storage.destroy_funcs.emplace_back([](const void*, const detail::destroy_t type, u8* data) {
 				switch (type)
 				{
 					case detail::destroy_t::PTR:
@@ -412,7 +481,9 @@ namespace errors::serialization
 				}
 			});
 			storage.names.push_back(op.get_name());
-			storage.operator_flags.emplace(operator_id, operator_special_flags{op.is_ephemeral(), op.return_has_ephemeral_drop()});
+			storage.weights.push_back(op.get_weight());
+			storage.operator_table.add(storage.operators.back(), meta.return_size_bytes,
+										operator_special_flags{op.is_ephemeral(), op.return_has_ephemeral_drop()});
 			return meta;
 		}
 
@@ -448,7 +519,7 @@ namespace errors::serialization
 
 		explicit gp_program(blt::u64 seed, const prog_config_t& config): seed_func([seed] {
 			return seed;
-		})
+		}), config(config)
 		{
 			create_threads();
 			set_config(config);
@@ -465,7 +536,8 @@ namespace errors::serialization
 			set_config(config);
 		}
 
-		explicit gp_program(std::function<blt::u64()> seed_func, const prog_config_t& config): seed_func(std::move(seed_func))
+		// the config is set before the threads are created, so they match the requested thread count
+		explicit gp_program(std::function<blt::u64()> seed_func, const prog_config_t& config): seed_func(std::move(seed_func)), config(config)
 		{
 			create_threads();
 			set_config(config);
@@ -481,6 +553,9 @@ namespace errors::serialization
 				if (thread->joinable())
 					thread->join();
 			}
+			// pooled trees reference the program, so they must be destroyed before we are
+			if (config.subtree_pool != nullptr)
+				config.subtree_pool->clear(*this);
 		}
 
 		void create_next_generation()
@@ -488,9 +563,40 @@ namespace errors::serialization
 			#ifdef BLT_TRACK_ALLOCATIONS
                 auto gen_alloc = blt::gp::tracker.start_measurement();
 			#endif
+			BLT_ASSERT_MSG(!async_steady_state || async_population_ready, "Population must be evaluated before it is bred from!");
 			// should already be empty
 			thread_helper.next_gen_left.store(selection_probabilities.replacement_amount.value_or(config.population_size), std::memory_order_release);
+			if (fused_evaluation)
+			{
+				// the children are evaluated as they are bred, the results are moved into the current stats by evaluate_fitness()
+				next_stats.clear();
+				next_pop.reset_fitness();
+				next_pop.begin_ranking(ranking_size(), evaluation_threads());
+				balance_evaluation = false;
+			} else if (steady_state && !async_steady_state)
+			{
+				// the children are bred into the start of the next population and evaluated there before they replace individuals
+				if (current_pop.get_arena() != nullptr || next_pop.get_arena() != nullptr)
+				{
+					current_pop.disable_arena();
+					next_pop.disable_arena();
+				}
+				if (next_pop.get_adjusted_fitness().size() != next_pop.get_individuals().size())
+					next_pop.reset_fitness();
+				next_stats.clear();
+				balance_evaluation = false;
+			}
+			// generational children are estimated as they are bred, while they are still in cache
+			next_pop_estimated = balance_evaluation && !steady_state;
+			if (next_pop_estimated)
+				next_estimates.resize(config.population_size);
+			const auto start = std::chrono::steady_clock::now();
 			(*thread_execution_service)(0);
+			if (fused_evaluation || (steady_state && !async_steady_state))
+			{
+				next_stats.evaluation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				next_pop_evaluated = true;
+			}
 			#ifdef BLT_TRACK_ALLOCATIONS
                 blt::gp::tracker.stop_measurement(gen_alloc);
                 gen_alloc.pretty_print("Generation");
@@ -499,7 +605,16 @@ namespace errors::serialization
 
 		void next_generation()
 		{
-			std::swap(current_pop, next_pop);
+			// children replace the current population in place
+			if (!steady_state)
+			{
+				std::swap(current_pop, next_pop);
+				std::swap(evaluation_estimates, next_estimates);
+			}
+			current_pop_evaluated = next_pop_evaluated;
+			next_pop_evaluated = false;
+			current_pop_estimated = next_pop_estimated;
+			next_pop_estimated = false;
 			++current_generation;
 		}
 
@@ -521,6 +636,38 @@ namespace errors::serialization
 			#endif
 		}
 
+		/**
+		* Overwrites individuals of the current population with trees evaluated elsewhere, such as migrants from another island (see
+		* island_model_t), and updates the statistics and ranking of the population to match. replace(i, tree, fitness) is called for each of
+		* the distinct indices and must write the new tree and its fitness, which has to come from the fitness function this program uses.
+		* Must not be called while a generation is being created or evaluated.
+		*/
+		template <typename Func>
+		void replace_individuals(const tracked_vector<size_t>& indices, Func&& replace)
+		{
+			auto& individuals = current_pop.get_individuals();
+			const auto& adjusted_fitness = current_pop.get_adjusted_fitness();
+			auto overall = current_stats.overall_fitness.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				const auto index = indices[i];
+				fitness_t fitness{};
+				overall -= adjusted_fitness[index];
+				replace(i, individuals[index].tree, fitness);
+				overall += fitness.adjusted_fitness;
+				current_pop.set_fitness(index, fitness);
+				if (async_population_ready)
+					async_slots.set_fitness(index, fitness.adjusted_fitness);
+			}
+			if (indices.empty())
+				return;
+			current_stats.overall_fitness = overall;
+			current_stats.average_fitness = overall / static_cast<double>(individuals.size());
+			current_stats.worst_fitness = *std::min_element(adjusted_fitness.begin(), adjusted_fitness.end());
+			current_pop.update_ranking(indices);
+			current_stats.best_fitness = adjusted_fitness[current_pop.get_ranking().front()];
+		}
+
         void reset_program(type_id root_type, bool eval_fitness_now = true)
         {
             current_generation = 0;
@@ -528,10 +675,20 @@ namespace errors::serialization
                 *this, root_type, config.population_size, config.initial_min_tree_size, config.initial_max_tree_size
             });
             next_pop = population_t(current_pop);
+            current_pop_evaluated = false;
+            next_pop_evaluated = false;
+            current_pop_estimated = false;
+            next_pop_estimated = false;
+            async_population_ready = false;
             BLT_ASSERT_MSG(current_pop.get_individuals().size() == config.population_size,
                            ("cur pop size: " + std::to_string(current_pop.get_individuals().size())).c_str());
             BLT_ASSERT_MSG(next_pop.get_individuals().size() == config.population_size,
                            ("next pop size: " + std::to_string(next_pop.get_individuals().size())).c_str());
+            if (config.use_tree_arena)
+            {
+                current_pop.enable_arena();
+                next_pop.enable_arena();
+            }
             if (eval_fitness_now)
                 evaluate_fitness_internal();
         }
@@ -551,6 +708,14 @@ namespace errors::serialization
 							("cur pop size: " + std::to_string(current_pop.get_individuals().size())).c_str());
 			BLT_ASSERT_MSG(next_pop.get_individuals().size() == config.population_size,
 							("next pop size: " + std::to_string(next_pop.get_individuals().size())).c_str());
+			if (config.use_tree_arena)
+			{
+				current_pop.enable_arena();
+				next_pop.enable_arena();
+			}
+			current_pop_estimated = false;
+			next_pop_estimated = false;
+			async_population_ready = false;
 		}
 
 		/**
@@ -567,6 +732,11 @@ namespace errors::serialization
 		void setup_generational_evaluation(FitnessFunc& fitness_function, Crossover& crossover_selection, Mutation& mutation_selection,
 											Reproduction& reproduction_selection, bool eval_fitness_now = true)
 		{
+			full_ranking = crossover_selection.requires_ranking() || mutation_selection.requires_ranking() || reproduction_selection.
+				requires_ranking();
+			fused_evaluation = config.evaluate_while_breeding;
+			steady_state = false;
+			async_steady_state = false;
 			if (config.threads == 1)
 			{
 				BLT_INFO("Starting generational with single thread variant!");
@@ -576,14 +746,7 @@ namespace errors::serialization
 
 						if (thread_helper.next_gen_left > 0)
 						{
-							current_stats.normalized_fitness.clear();
-							double sum_of_prob = 0;
-							for (const auto& ind : current_pop)
-							{
-								const auto prob = (ind.fitness.adjusted_fitness / current_stats.overall_fitness);
-								current_stats.normalized_fitness.push_back(sum_of_prob + prob);
-								sum_of_prob += prob;
-							}
+							compute_normalized_fitness();
 
 							const auto args = get_selector_args();
 
@@ -591,7 +754,13 @@ namespace errors::serialization
 							mutation_selection.pre_process(*this, current_pop);
 							reproduction_selection.pre_process(*this, current_pop);
 
+							// the next population is rewritten from scratch, so its arena can be reclaimed
+							next_pop.reset_arena();
+							if (config.use_tree_sharing)
+								current_pop.make_shareable();
 							size_t start = detail::perform_elitism(args, next_pop);
+							if (fused_evaluation)
+								copy_elite_fitness(start);
 
 							while (start < config.population_size)
 							{
@@ -599,9 +768,21 @@ namespace errors::serialization
 								tree_t* c2 = nullptr;
 								if (start + 1 < config.population_size)
 									c2 = &next_pop.get_individuals()[start + 1].tree;
-								start += perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+								const auto created = perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+								if (fused_evaluation)
+									perform_fitness_function(next_pop, next_stats, start, start + created, fitness_function);
+								start += created;
 							}
 
+							if (fused_evaluation)
+							{
+								if (config.subtree_pool != nullptr)
+								{
+									config.subtree_pool->begin_refill(*this);
+									config.subtree_pool->refill(*this);
+								}
+								rank_population(next_pop, 0);
+							}
 							thread_helper.next_gen_left = 0;
 						}
 					}));
@@ -611,47 +792,36 @@ namespace errors::serialization
 				std::scoped_lock lock(thread_helper.thread_function_control);
 				thread_execution_service = std::unique_ptr<std::function<void(size_t)>>(new std::function(
 					[this, &fitness_function, &crossover_selection, &mutation_selection, &reproduction_selection](const size_t id) {
-						thread_helper.barrier.wait();
+						thread_helper.barrier.wait(id);
 
 						multi_threaded_fitness_eval<FitnessFunc>()(fitness_function, id);
 
 						if (thread_helper.next_gen_left > 0)
 						{
-							thread_helper.barrier.wait();
+							thread_helper.barrier.wait(id);
 							auto args = get_selector_args();
 							if (id == 0)
 							{
-								current_stats.normalized_fitness.clear();
-								double sum_of_prob = 0;
-								for (const auto& ind : current_pop)
-								{
-									const auto prob = (ind.fitness.adjusted_fitness / current_stats.overall_fitness);
-									current_stats.normalized_fitness.push_back(sum_of_prob + prob);
-									sum_of_prob += prob;
-								}
+								compute_normalized_fitness();
 
 								crossover_selection.pre_process(*this, current_pop);
 								if (&crossover_selection != &mutation_selection)
 									mutation_selection.pre_process(*this, current_pop);
 								if (&crossover_selection != &reproduction_selection)
 									reproduction_selection.pre_process(*this, current_pop);
+								next_pop.reset_arena();
+								if (config.use_tree_sharing)
+									current_pop.make_shareable();
 								const auto elite_amount = detail::perform_elitism(args, next_pop);
-								thread_helper.next_gen_left -= elite_amount;
+								if (fused_evaluation)
+									copy_elite_fitness(elite_amount);
+								if (balance_evaluation)
+									estimate_children(0, elite_amount);
+								thread_helper.work.reset(thread_helper.next_gen_left - elite_amount);
 							}
-							thread_helper.barrier.wait();
-
-							while (thread_helper.next_gen_left > 0)
-							{
-								size_t size = 0;
-								size_t begin = 0;
-								size_t end = thread_helper.next_gen_left.load(std::memory_order_relaxed);
-								do
-								{
-									size = std::min(end, config.evaluation_size);
-									begin = end - size;
-								} while (!thread_helper.next_gen_left.compare_exchange_weak(
-									end, end - size, std::memory_order::memory_order_relaxed, std::memory_order::memory_order_relaxed));
+							thread_helper.barrier.wait(id);
 
+							thread_helper.work.for_each(id, config.evaluation_size, [&](size_t begin, const size_t end) {
 								while (begin != end)
 								{
 									auto index = config.elites + begin;
@@ -659,11 +829,34 @@ namespace errors::serialization
 									tree_t* c2 = nullptr;
 									if (begin + 1 < end)
 										c2 = &next_pop.get_individuals()[index + 1].tree;
-									begin += perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+									const auto created = perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+									if (fused_evaluation)
+										perform_fitness_function(next_pop, next_stats, index, index + created, fitness_function);
+									if (balance_evaluation)
+										estimate_children(index, index + created);
+									begin += created;
+								}
+							});
+							if (id == 0)
+								thread_helper.next_gen_left = 0;
+
+							if (fused_evaluation)
+							{
+								const auto finished = std::chrono::steady_clock::now();
+								thread_helper.barrier.wait(id);
+								add_idle_time(next_stats, finished);
+								// mutation has finished taking trees from the pool, so it can be refilled alongside the ranking
+								if (config.subtree_pool != nullptr)
+								{
+									if (id == 0)
+										config.subtree_pool->begin_refill(*this);
+									thread_helper.barrier.wait(id);
+									config.subtree_pool->refill(*this);
 								}
+								rank_population(next_pop, id);
 							}
 						}
-						thread_helper.barrier.wait();
+						thread_helper.barrier.wait(id);
 					}));
 				thread_helper.thread_function_condition.notify_all();
 			}
@@ -671,12 +864,24 @@ namespace errors::serialization
 				evaluate_fitness_internal();
 		}
 
+		/**
+		* Steady state evolution which replaces replacement_amount individuals of the population every generation. The children are bred
+		* from the current population and evaluated straight away, then the replacement strategy picks which individuals they replace.
+		* Only the children are evaluated, and the statistics and ranking are updated from the replaced individuals. The replacement strategy
+		* selects on every thread at once, see begin_replacement().
+		*/
 		template <typename FitnessFunc, typename SelectionStrat, typename Crossover, typename Mutation, typename Reproduction>
 		void setup_steady_state_evaluation(FitnessFunc& fitness_function, SelectionStrat& replacement_strategy, size_t replacement_amount,
 											Crossover& crossover_selection, Mutation& mutation_selection, Reproduction& reproduction_selection,
 											const bool eval_fitness_now = true)
 		{
+			BLT_ASSERT_MSG(replacement_amount < config.population_size, "Steady state must keep part of the population!");
 			selection_probabilities.replacement_amount = replacement_amount;
+			fused_evaluation = false;
+			steady_state = true;
+			async_steady_state = false;
+			full_ranking = replacement_strategy.requires_ranking() || crossover_selection.requires_ranking() || mutation_selection.
+				requires_ranking() || reproduction_selection.requires_ranking();
 			if (config.threads == 1)
 			{
 				BLT_INFO("Starting steady state with single thread variant!");
@@ -686,33 +891,34 @@ namespace errors::serialization
 
 						if (thread_helper.next_gen_left > 0)
 						{
-							current_stats.normalized_fitness.clear();
-							double sum_of_prob = 0;
-							for (const auto& ind : current_pop)
-							{
-								const auto prob = (ind.fitness.adjusted_fitness / current_stats.overall_fitness);
-								current_stats.normalized_fitness.push_back(sum_of_prob + prob);
-								sum_of_prob += prob;
-							}
-
-							next_pop = population_t(current_pop);
-
-							replacement_strategy.pre_process(*this, next_pop);
+							compute_normalized_fitness();
+							replacement_strategy.pre_process(*this, current_pop);
 							crossover_selection.pre_process(*this, current_pop);
 							mutation_selection.pre_process(*this, current_pop);
 							reproduction_selection.pre_process(*this, current_pop);
 
-							while (thread_helper.next_gen_left > 0)
+							const size_t amount = thread_helper.next_gen_left;
+							begin_replacement(amount);
+							size_t start = 0;
+							while (start < amount)
 							{
-								tree_t& c1 = replacement_strategy.select(*this, next_pop);
+								tree_t& c1 = next_pop.get_individuals()[start].tree;
 								tree_t* c2 = nullptr;
-								if (thread_helper.next_gen_left > 1)
-									while (c2 != &c1)
-										c2 = &replacement_strategy.select(*this, next_pop);
-								thread_helper.next_gen_left -= perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1,
-																				c2);
+								if (start + 1 < amount)
+									c2 = &next_pop.get_individuals()[start + 1].tree;
+								const auto created = perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+								perform_fitness_function(next_pop, next_stats, start, start + created, fitness_function);
+								start += created;
 							}
 
+							claim_replacements(replacement_strategy, amount, 0, 1);
+							replace_claimed(amount, 0, 1);
+							finish_replacement();
+							if (config.subtree_pool != nullptr)
+							{
+								config.subtree_pool->begin_refill(*this);
+								config.subtree_pool->refill(*this);
+							}
 							thread_helper.next_gen_left = 0;
 						}
 					}));
@@ -723,57 +929,107 @@ namespace errors::serialization
 				thread_execution_service = std::unique_ptr<std::function<void(size_t)>>(new std::function(
 					[this, &fitness_function, &replacement_strategy, &crossover_selection, &mutation_selection, &reproduction_selection](
 						const size_t id) {
-						thread_helper.barrier.wait();
+						thread_helper.barrier.wait(id);
 
 						multi_threaded_fitness_eval<FitnessFunc>()(fitness_function, id);
 
 						if (thread_helper.next_gen_left > 0)
 						{
-							thread_helper.barrier.wait();
+							const size_t amount = thread_helper.next_gen_left;
+							thread_helper.barrier.wait(id);
 							if (id == 0)
 							{
-								current_stats.normalized_fitness.clear();
-								double sum_of_prob = 0;
-								for (const auto& ind : current_pop)
-								{
-									const auto prob = (ind.fitness.adjusted_fitness / current_stats.overall_fitness);
-									current_stats.normalized_fitness.push_back(sum_of_prob + prob);
-									sum_of_prob += prob;
-								}
-
-								current_pop = population_t(next_pop);
-
-								replacement_strategy.pre_process(*this, next_pop);
+								compute_normalized_fitness();
+								replacement_strategy.pre_process(*this, current_pop);
 								crossover_selection.pre_process(*this, current_pop);
 								if (&crossover_selection != &mutation_selection)
 									mutation_selection.pre_process(*this, current_pop);
 								if (&crossover_selection != &reproduction_selection)
 									reproduction_selection.pre_process(*this, current_pop);
+								begin_replacement(amount);
+								thread_helper.work.reset(amount);
 							}
-							thread_helper.barrier.wait();
-
-							while (thread_helper.next_gen_left > 0)
-							{
-								size_t size = 0;
-								size_t end = thread_helper.next_gen_left.load(std::memory_order_relaxed);
-								do
-								{
-									size = std::min(end, config.evaluation_size);
-								} while (!thread_helper.next_gen_left.compare_exchange_weak(
-									end, end - size, std::memory_order::memory_order_relaxed, std::memory_order::memory_order_relaxed));
+							thread_helper.barrier.wait(id);
 
-								while (size > 0)
+							thread_helper.work.for_each(id, config.evaluation_size, [&](size_t begin, const size_t end) {
+								while (begin != end)
 								{
-									tree_t& c1 = replacement_strategy.select(*this, next_pop);
+									tree_t& c1 = next_pop.get_individuals()[begin].tree;
 									tree_t* c2 = nullptr;
-									if (thread_helper.next_gen_left > 1)
-										while (c2 != &c1)
-											c2 = &replacement_strategy.select(*this, next_pop);
-									size -= perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+									if (begin + 1 < end)
+										c2 = &next_pop.get_individuals()[begin + 1].tree;
+									const auto created = perform_selection(crossover_selection, mutation_selection, reproduction_selection, c1, c2);
+									perform_fitness_function(next_pop, next_stats, begin, begin + created, fitness_function);
+									begin += created;
 								}
+							});
+							thread_helper.barrier.wait(id);
+
+							// mutation has finished taking trees from the pool, so it is refilled while the ranking is updated
+							if (id == 0 && config.subtree_pool != nullptr)
+								config.subtree_pool->begin_refill(*this);
+							claim_replacements(replacement_strategy, amount, id, evaluation_threads());
+							thread_helper.barrier.wait(id);
+							replace_claimed(amount, id, evaluation_threads());
+							thread_helper.barrier.wait(id);
+							if (id == 0)
+							{
+								finish_replacement();
+								thread_helper.next_gen_left = 0;
 							}
+							if (config.subtree_pool != nullptr)
+								config.subtree_pool->refill(*this);
 						}
-						thread_helper.barrier.wait();
+						thread_helper.barrier.wait(id);
+					}));
+				thread_helper.thread_function_condition.notify_all();
+			}
+			if (eval_fitness_now)
+				evaluate_fitness_internal();
+		}
+
+		/**
+		* Steady state evolution without generations inside the program. Every thread repeatedly breeds a child from parents picked by
+		* tournament, evaluates it and replaces the loser of another tournament with it, synchronising only on the individuals it touches.
+		* create_next_generation() runs until replacement_amount children have been placed, evaluate_fitness() only samples the statistics.
+		*
+		* The selection operators of the other modes read the population without synchronisation, so parents and victims are instead picked
+		* by tournaments of tournament_size over the adjusted fitness. Trees are moved out of the population's arena, as it is never reset.
+		*/
+		template <typename FitnessFunc>
+		void setup_async_steady_state_evaluation(FitnessFunc& fitness_function, const size_t replacement_amount, const size_t tournament_size = 3,
+												const bool eval_fitness_now = true)
+		{
+			BLT_ASSERT_MSG(tournament_size > 0, "Tournaments must contain at least one individual!");
+			// every thread holds at most one claim, which must leave a slot for the others to replace
+			BLT_ASSERT_MSG(config.population_size > evaluation_threads(), "Population must be larger than the number of threads!");
+			selection_probabilities.replacement_amount = replacement_amount;
+			fused_evaluation = false;
+			steady_state = true;
+			async_steady_state = true;
+			async_population_ready = false;
+			full_ranking = false;
+			if (config.threads == 1)
+			{
+				BLT_INFO("Starting asynchronous steady state with single thread variant!");
+				thread_execution_service = std::unique_ptr<std::function<void(size_t)>>(new std::function(
+					[this, &fitness_function, tournament_size](size_t) {
+						single_threaded_fitness_eval<FitnessFunc>()(fitness_function);
+						perform_async_births(fitness_function, tournament_size);
+					}));
+			} else
+			{
+				BLT_INFO("Starting asynchronous steady state thread execution service!");
+				std::scoped_lock lock(thread_helper.thread_function_control);
+				thread_execution_service = std::unique_ptr<std::function<void(size_t)>>(new std::function(
+					[this, &fitness_function, tournament_size](const size_t id) {
+						thread_helper.barrier.wait(id);
+
+						multi_threaded_fitness_eval<FitnessFunc>()(fitness_function, id);
+						// threads only meet again once every child has been placed
+						perform_async_births(fitness_function, tournament_size);
+
+						thread_helper.barrier.wait(id);
 					}));
 				thread_helper.thread_function_condition.notify_all();
 			}
@@ -796,7 +1052,7 @@ namespace errors::serialization
 			// we wanted a terminal, but could not find one, so we will select from a function that has a terminal
 			if (storage.terminals[id].empty())
 				return select_non_terminal_too_deep(id);
-			return get_random().select(storage.terminals[id]);
+			return storage.terminal_tables[id].select(get_random());
 		}
 
 		operator_id select_non_terminal(type_id id)
@@ -805,7 +1061,7 @@ namespace errors::serialization
 			// was considering an std::optional<> but that would complicate the generator code considerably. I'll mark this as a TODO for v2
 			if (storage.non_terminals[id].empty())
 				return select_terminal(id);
-			return get_random().select(storage.non_terminals[id]);
+			return storage.non_terminal_tables[id].select(get_random());
 		}
 
 		operator_id select_non_terminal_too_deep(type_id id)
@@ -813,7 +1069,7 @@ namespace errors::serialization
 			// this should probably be an error.
 			if (storage.operators_ordered_terminals[id].empty())
 				BLT_ABORT("An impossible state has been reached. Please consult the manual. Error 43");
-			return get_random().select(storage.operators_ordered_terminals[id]).first;
+			return storage.ordered_terminal_tables[id].select(get_random());
 		}
 
 		auto& get_current_pop()
@@ -844,6 +1100,11 @@ namespace errors::serialization
 			return storage.operators[id];
 		}
 
+		[[nodiscard]] const operator_table_t& get_operator_table() const
+		{
+			return storage.operator_table;
+		}
+
 		[[nodiscard]] detail::print_func_t& get_print_func(operator_id id)
 		{
 			return storage.print_funcs[id];
@@ -884,19 +1145,39 @@ namespace errors::serialization
 			return current_stats;
 		}
 
+		[[nodiscard]] const evaluation_cost_model_t& get_cost_model() const
+		{
+			return cost_model;
+		}
+
+		// the barrier shared by every thread running the execution service, records how long each thread has waited on it
+		[[nodiscard]] adaptive_barrier_t& get_barrier()
+		{
+			return thread_helper.barrier;
+		}
+
 		[[nodiscard]] bool is_operator_ephemeral(const operator_id id) const
 		{
-			return storage.operator_flags.find(static_cast<size_t>(id))->second.is_ephemeral();
+			return storage.operator_table.flags[id].is_ephemeral();
 		}
 
 		[[nodiscard]] bool operator_has_ephemeral_drop(const operator_id id) const
 		{
-			return storage.operator_flags.find(static_cast<size_t>(id))->second.has_ephemeral_drop();
+			return storage.operator_table.flags[id].has_ephemeral_drop();
 		}
 
 		[[nodiscard]] operator_special_flags get_operator_flags(const operator_id id) const
 		{
-			return storage.operator_flags.find(static_cast<size_t>(id))->second;
+			return storage.operator_table.flags[id];
+		}
+
+		/**
+		 * @return the tree node for this operator, built from the operator table in a single lookup
+		 */
+		[[nodiscard]] op_container_t get_operator_container(const operator_id id) const
+		{
+			const auto flags = storage.operator_table.flags[id];
+			return {storage.operator_table.return_sizes[id], id, flags.is_ephemeral(), flags};
 		}
 
 		void set_operations(program_operator_storage_t op)
@@ -905,12 +1186,17 @@ namespace errors::serialization
 		}
 
 		template <size_t size>
-		std::array<size_t, size> get_best_indexes() const
+		std::array<size_t, size> get_best_indexes()
 		{
+			// usually only the elites are ranked
+			if (current_pop.get_ranking().size() < std::min(size, current_pop.get_individuals().size()))
+				current_pop.rank_by_fitness(size);
+			const auto& ranking = current_pop.get_ranking();
+
 			std::array<size_t, size> arr;
 
 			for (auto [i, a] : enumerate(arr))
-				a = std::min(i, config.population_size);
+				a = ranking[std::min(i, ranking.size() - 1)];
 
 			return arr;
 		}
@@ -927,12 +1213,21 @@ namespace errors::serialization
 		template <blt::size_t size>
 		auto get_best_individuals()
 		{
-			return convert_array<std::array<std::reference_wrapper<individual_t>, size>>(get_best_indexes<size>(),
-																						[this](auto&& arr, blt::size_t index) -> individual_t& {
-																							return current_pop.get_individuals()[arr[index]];
-																						}, std::make_integer_sequence<blt::size_t, size>());
+			return convert_array<std::array<individual_ref_t, size>>(get_best_indexes<size>(),
+																	[this](auto&& arr, blt::size_t index) -> individual_ref_t {
+																		return current_pop.get_individual(arr[index]);
+																	}, std::make_integer_sequence<blt::size_t, size>());
 		}
 
+		/**
+		* Runs func once on every thread owned by the program, the calling thread is always given id 0. func is responsible for splitting
+		* up the work between threads, which is usually done by claiming chunks from an atomic counter.
+		*
+		* Worker threads are only available until one of the evaluation setup functions has been called, after which they are parked inside
+		* the evaluation service and func will only be run on the calling thread.
+		*/
+		void execute_on_threads(const std::function<void(size_t)>& func);
+
 		void save_generation(fs::writer_t& writer);
 
 		void save_state(fs::writer_t& writer);
@@ -948,16 +1243,12 @@ namespace errors::serialization
 			return [this](FitnessFunc& fitness_function) {
 				if (thread_helper.evaluation_left > 0)
 				{
-					current_stats.normalized_fitness.clear();
-					double sum_of_prob = 0;
-					perform_fitness_function(0, current_pop.get_individuals().size(), fitness_function);
-					for (const auto& ind : current_pop)
-					{
-						const auto prob = (ind.fitness.adjusted_fitness / current_stats.overall_fitness);
-						current_stats.normalized_fitness.push_back(sum_of_prob + prob);
-						sum_of_prob += prob;
-					}
+					perform_fitness_function(current_pop, current_stats, 0, current_pop.get_individuals().size(), fitness_function);
+					rank_population(current_pop, 0);
+					compute_normalized_fitness();
 					thread_helper.evaluation_left = 0;
+					if (config.subtree_pool != nullptr)
+						config.subtree_pool->refill(*this);
 				}
 			};
 		}
@@ -968,58 +1259,102 @@ namespace errors::serialization
 			return [this](FitnessFunc& fitness_function, size_t thread_id) {
 				if (thread_helper.evaluation_left > 0)
 				{
-					thread_helper.barrier.wait();
-					while (thread_helper.evaluation_left > 0)
-					{
-						size_t size = 0;
-						size_t begin = 0;
-						size_t end = thread_helper.evaluation_left.load(std::memory_order_relaxed);
-						do
-						{
-							size = std::min(end, config.evaluation_size);
-							begin = end - size;
-						} while (!thread_helper.evaluation_left.compare_exchange_weak(end, end - size, std::memory_order::memory_order_relaxed,
-																					std::memory_order::memory_order_relaxed));
-						perform_fitness_function(begin, end, fitness_function);
-					}
-					thread_helper.barrier.wait();
+					thread_helper.barrier.wait(thread_id);
+					thread_helper.work.for_each(thread_id, config.evaluation_size, [&](const size_t begin, const size_t end) {
+						perform_fitness_function(current_pop, current_stats, begin, end, fitness_function);
+					});
+					if (thread_id == 0)
+						thread_helper.evaluation_left = 0;
+					// threads which run out of trees to evaluate would otherwise be idle at the barrier. the ranking only needs the other
+					// threads to have finished evaluating, so the last of them does not have to wait for everyone else to finish refilling
+					const auto evaluated = thread_helper.barrier.arrive();
+					if (config.subtree_pool != nullptr)
+						config.subtree_pool->refill(*this);
+					const auto finished = std::chrono::steady_clock::now();
+					thread_helper.barrier.wait(thread_id, evaluated);
+					add_idle_time(current_stats, finished);
+					rank_population(current_pop, thread_id);
+					thread_helper.barrier.wait(thread_id);
 				}
 			};
 		}
 
 		template <typename FitnessFunction>
-		void perform_fitness_function(const size_t begin, const size_t end, FitnessFunction& fitness_function)
+		void call_fitness_function(FitnessFunction& fitness_function, const tree_t& tree, fitness_t& fitness, const size_t index)
 		{
 			using LambdaReturn = std::invoke_result_t<decltype(fitness_function), const tree_t&, fitness_t&, size_t>;
-			for (size_t i = begin; i < end; i++)
+			if constexpr (std::is_same_v<LambdaReturn, bool> || std::is_convertible_v<LambdaReturn, bool>)
 			{
-				auto& ind = current_pop.get_individuals()[i];
-
-				ind.fitness = {};
-				if constexpr (std::is_same_v<LambdaReturn, bool> || std::is_convertible_v<LambdaReturn, bool>)
-				{
-					if (fitness_function(ind.tree, ind.fitness, i))
-						fitness_should_exit = true;
-				} else
-				{
-					fitness_function(ind.tree, ind.fitness, i);
-				}
+				if (fitness_function(tree, fitness, index))
+					fitness_should_exit = true;
+			} else
+			{
+				fitness_function(tree, fitness, index);
+			}
+		}
 
-				// auto old_best = current_stats.best_fitness.load(std::memory_order_relaxed);
-				// while (ind.fitness.adjusted_fitness > old_best && !current_stats.best_fitness.compare_exchange_weak(
-				// 	old_best, ind.fitness.adjusted_fitness, std::memory_order_relaxed, std::memory_order_relaxed))
-				// {}
-				//
-				// auto old_worst = current_stats.worst_fitness.load(std::memory_order_relaxed);
-				// while (ind.fitness.adjusted_fitness < old_worst && !current_stats.worst_fitness.compare_exchange_weak(
-				// 	old_worst, ind.fitness.adjusted_fitness, std::memory_order_relaxed, std::memory_order_relaxed))
-				// {}
-
-				auto old_overall = current_stats.overall_fitness.load(std::memory_order_relaxed);
-				while (!current_stats.overall_fitness.compare_exchange_weak(old_overall, ind.fitness.adjusted_fitness + old_overall,
+		template <typename FitnessFunction>
+		void perform_fitness_function(population_t& population, population_stats& stats, const size_t begin, const size_t end,
+									FitnessFunction& fitness_function)
+		{
+			// the best fitness comes from the ranking, the worst is only known to the threads which evaluated it
+			double worst = std::numeric_limits<double>::max();
+			for (size_t i = begin; i < end; i++)
+			{
+				auto& ind = population.get_individuals()[i];
+				const auto start = balance_evaluation ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+				fitness_t fitness{};
+				call_fitness_function(fitness_function, ind.tree, fitness, i);
+				if (balance_evaluation)
+					evaluation_times[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+				population.set_fitness(i, fitness);
+				worst = std::min(worst, fitness.adjusted_fitness);
+
+				auto old_overall = stats.overall_fitness.load(std::memory_order_relaxed);
+				while (!stats.overall_fitness.compare_exchange_weak(old_overall, fitness.adjusted_fitness + old_overall,
 																			std::memory_order_relaxed, std::memory_order_relaxed))
 				{}
 			}
+
+			auto old_worst = stats.worst_fitness.load(std::memory_order_relaxed);
+			while (worst < old_worst && !stats.worst_fitness.compare_exchange_weak(old_worst, worst, std::memory_order_relaxed,
+																							std::memory_order_relaxed))
+			{}
+		}
+
+		/**
+		* The elites are unchanged copies of the best individuals of the current population, so fused evaluation takes their fitness from
+		* the current population instead of evaluating them again. The copies count towards the statistics like evaluated children do.
+		*/
+		void copy_elite_fitness(const size_t elites)
+		{
+			const auto& pop = current_pop;
+			const auto& ranking = pop.get_ranking();
+			double overall = 0;
+			double worst = std::numeric_limits<double>::max();
+			for (size_t i = 0; i < elites; i++)
+			{
+				const auto fitness = pop.get_fitness(ranking[i]);
+				next_pop.set_fitness(i, fitness);
+				overall += fitness.adjusted_fitness;
+				worst = std::min(worst, fitness.adjusted_fitness);
+			}
+
+			auto old_overall = next_stats.overall_fitness.load(std::memory_order_relaxed);
+			while (!next_stats.overall_fitness.compare_exchange_weak(old_overall, overall + old_overall, std::memory_order_relaxed,
+																	std::memory_order_relaxed))
+			{}
+			auto old_worst = next_stats.worst_fitness.load(std::memory_order_relaxed);
+			while (worst < old_worst && !next_stats.worst_fitness.compare_exchange_weak(old_worst, worst, std::memory_order_relaxed,
+																						std::memory_order_relaxed))
+			{}
+		}
+
+		void estimate_children(const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				next_estimates[i] = cost_model.estimate(next_pop.get_individuals()[i].tree);
 		}
 
 		template <typename Crossover, typename Mutation, typename Reproduction>
@@ -1100,8 +1435,8 @@ namespace errors::serialization
 				#ifdef BLT_TRACK_ALLOCATIONS
                 auto state = tracker.start_measurement_thread_local();
 				#endif
-				// reproduction
-				c1.copy_fast(reproduction.select(*this, current_pop));
+				// reproduction, which shares the parent's storage if the current population is shareable
+				c1.share(reproduction.select(*this, current_pop));
 				#ifdef BLT_TRACK_ALLOCATIONS
                 tracker.stop_measurement_thread_local(state);
                 reproduction_calls.call();
@@ -1118,6 +1453,197 @@ namespace errors::serialization
 			return 0;
 		}
 
+		/**
+		* Replacement of a steady state generation, split between thread_count threads. The first amount individuals of the next population
+		* have been bred and evaluated, they are swapped into the current population in place of individuals picked by the replacement
+		* strategy. begin_replacement() is called by a single thread before breeding. Every thread then calls claim_replacements(), and once
+		* they all have, replace_claimed(). finish_replacement() is called by a single thread afterwards and carries the statistics of the
+		* current population over into next_stats.
+		*
+		* Victims are claimed in a bitmap, so the replacement strategy can select on every thread at once without two threads picking the
+		* same individual. Nothing is written to the current population until every victim has been claimed.
+		*/
+		void begin_replacement(const size_t amount)
+		{
+			if (replacement_claims.size() != current_pop.get_individuals().size())
+				replacement_claims.reset(current_pop.get_individuals().size());
+			replaced_indices.resize(amount);
+			replaced_fitness = 0;
+			worst_replaced = false;
+		}
+
+		template <typename SelectionStrat>
+		void claim_replacements(SelectionStrat& replacement_strategy, const size_t amount, const size_t thread_id, const size_t thread_count)
+		{
+			for (size_t i = amount * thread_id / thread_count; i < amount * (thread_id + 1) / thread_count; i++)
+			{
+				size_t victim;
+				do
+				{
+					victim = current_pop.index_of(replacement_strategy.select(*this, current_pop));
+				} while (!replacement_claims.try_claim(victim));
+				replaced_indices[i] = victim;
+			}
+		}
+
+		void replace_claimed(const size_t amount, const size_t thread_id, const size_t thread_count)
+		{
+			auto& individuals = current_pop.get_individuals();
+			const auto& adjusted_fitness = current_pop.get_adjusted_fitness();
+			const auto old_worst = current_stats.worst_fitness.load(std::memory_order_relaxed);
+			double replaced = 0;
+			bool worst = false;
+			for (size_t i = amount * thread_id / thread_count; i < amount * (thread_id + 1) / thread_count; i++)
+			{
+				const auto victim = replaced_indices[i];
+				replaced += adjusted_fitness[victim];
+				worst |= adjusted_fitness[victim] <= old_worst;
+				std::swap(individuals[victim].tree, next_pop.get_individuals()[i].tree);
+				current_pop.set_fitness(victim, next_pop.get_fitness(i));
+				// every claim has been made, so nobody is selecting anymore
+				replacement_claims.release(victim);
+			}
+			auto old_replaced = replaced_fitness.load(std::memory_order_relaxed);
+			while (!replaced_fitness.compare_exchange_weak(old_replaced, old_replaced + replaced, std::memory_order_relaxed,
+															std::memory_order_relaxed))
+			{}
+			if (worst)
+				worst_replaced.store(true, std::memory_order_relaxed);
+		}
+
+		void finish_replacement()
+		{
+			const auto& adjusted_fitness = current_pop.get_adjusted_fitness();
+			// next_stats holds the statistics of the children, from their evaluation
+			next_stats.overall_fitness = current_stats.overall_fitness.load(std::memory_order_relaxed) + next_stats.overall_fitness.load(
+				std::memory_order_relaxed) - replaced_fitness.load(std::memory_order_relaxed);
+			// the worst individual is only searched for again if it may have been replaced
+			if (worst_replaced.load(std::memory_order_relaxed))
+				next_stats.worst_fitness = *std::min_element(adjusted_fitness.begin(), adjusted_fitness.end());
+			else
+				next_stats.worst_fitness = std::min(current_stats.worst_fitness.load(std::memory_order_relaxed),
+													next_stats.worst_fitness.load(std::memory_order_relaxed));
+			current_pop.update_ranking(replaced_indices);
+		}
+
+		// places children into the current population until next_gen_left runs out, see setup_async_steady_state_evaluation()
+		template <typename FitnessFunction>
+		void perform_async_births(FitnessFunction& fitness_function, const size_t tournament_size)
+		{
+			thread_local tree_t children[2]{tree_t{*this}, tree_t{*this}};
+			// the children are empty, but may still point at whichever program last used them on this thread, which could be gone by now
+			children[0].clear(*this);
+			children[1].clear(*this);
+			auto& individuals = current_pop.get_individuals();
+			while (!fitness_should_exit)
+			{
+				auto left = thread_helper.next_gen_left.load(std::memory_order_relaxed);
+				size_t claimed;
+				do
+				{
+					claimed = std::min<u64>(left, 2);
+				} while (claimed > 0 && !thread_helper.next_gen_left.compare_exchange_weak(left, left - claimed, std::memory_order_relaxed,
+																						std::memory_order_relaxed));
+				if (claimed == 0)
+					break;
+
+				size_t created = 1;
+				if (get_random().choice(selection_probabilities.crossover_chance))
+				{
+					size_t runs = 0;
+					while (true)
+					{
+						const auto p1 = lock_async_parent(tournament_size);
+						const auto p2 = lock_async_parent(tournament_size);
+						children[0].copy_fast(individuals[p1].tree);
+						children[1].copy_fast(individuals[p2].tree);
+						bool crossed = config.crossover.get().apply(*this, individuals[p1].tree, individuals[p2].tree, children[0],
+																		children[1]);
+						if (!crossed && ++runs >= config.crossover.get().get_config().max_crossover_iterations)
+						{
+							// the parents are reproduced instead
+							children[0].copy_fast(individuals[p1].tree);
+							children[1].copy_fast(individuals[p2].tree);
+							crossed = true;
+						}
+						async_slots.unlock_shared(p1);
+						async_slots.unlock_shared(p2);
+						if (crossed)
+							break;
+					}
+					created = claimed;
+				} else if (get_random().choice(selection_probabilities.mutation_chance))
+				{
+					while (true)
+					{
+						const auto p = lock_async_parent(tournament_size);
+						children[0].copy_fast(individuals[p].tree);
+						const bool mutated = config.mutator.get().apply(*this, individuals[p].tree, children[0]);
+						async_slots.unlock_shared(p);
+						if (mutated)
+							break;
+					}
+				} else
+				{
+					const auto p = lock_async_parent(tournament_size);
+					children[0].copy_fast(individuals[p].tree);
+					async_slots.unlock_shared(p);
+				}
+				if (created < claimed)
+					thread_helper.next_gen_left.fetch_add(claimed - created, std::memory_order_relaxed);
+
+				for (size_t i = 0; i < created; i++)
+				{
+					const auto victim = claim_async_victim(tournament_size);
+					fitness_t fitness{};
+					call_fitness_function(fitness_function, children[i], fitness, victim);
+					async_slots.lock_claimed(victim);
+					individuals[victim].tree.copy_fast(children[i]);
+					current_pop.set_fitness(victim, fitness);
+					async_slots.set_fitness(victim, fitness.adjusted_fitness);
+					async_slots.unlock(victim);
+				}
+			}
+			// the children would otherwise keep their values alive until the thread exits
+			children[0].clear(*this);
+			children[1].clear(*this);
+		}
+
+		// read locks the winner of a tournament over the current population, which must be unlocked once it has been bred from
+		size_t lock_async_parent(const size_t tournament_size)
+		{
+			const auto size = current_pop.get_individuals().size();
+			auto best = get_random().get_u64(0, size);
+			for (size_t i = 1; i < tournament_size; i++)
+			{
+				const auto index = get_random().get_u64(0, size);
+				if (async_slots.get_fitness(index) > async_slots.get_fitness(best))
+					best = index;
+			}
+			async_slots.lock_shared(best);
+			return best;
+		}
+
+		// claims the loser of a tournament over the slots nobody else has claimed
+		size_t claim_async_victim(const size_t tournament_size)
+		{
+			const auto size = current_pop.get_individuals().size();
+			while (true)
+			{
+				auto worst = size;
+				for (size_t i = 0; i < tournament_size; i++)
+				{
+					const auto index = get_random().get_u64(0, size);
+					if (async_slots.is_claimed(index))
+						continue;
+					if (worst == size || async_slots.get_fitness(index) < async_slots.get_fitness(worst))
+						worst = index;
+				}
+				if (worst != size && async_slots.try_claim(worst))
+					return worst;
+			}
+		}
+
 		selector_args get_selector_args()
 		{
 			return {*this, current_pop, current_stats, config, get_random()};
@@ -1131,19 +1657,129 @@ namespace errors::serialization
 
 		void create_threads();
 
+		// number of individuals ranked after every evaluation, the elites are always ranked
+		[[nodiscard]] size_t ranking_size() const
+		{
+			return full_ranking ? config.population_size : std::max<size_t>(config.elites, 1);
+		}
+
+		// threads running the evaluation service, the main thread included. the worker threads are created with the program, so this is not
+		// config.threads if set_config() has changed it since
+		[[nodiscard]] size_t evaluation_threads() const
+		{
+			return config.threads == 1 ? 1 : thread_helper.threads.size() + 1;
+		}
+
+		// ranks the population together with every other thread running the evaluation, see population_t::begin_ranking()
+		void rank_population(population_t& population, const size_t thread_id)
+		{
+			population.rank_slice(thread_id);
+			for (size_t step = 1; step < evaluation_threads(); step *= 2)
+			{
+				thread_helper.barrier.wait(thread_id);
+				population.merge_ranked_slices(thread_id, step);
+			}
+		}
+
+		// the trees are taken out of the arena, which would otherwise grow with every child placed into the population
+		void prepare_async_population()
+		{
+			current_pop.disable_arena();
+			async_slots.reset(current_pop.get_individuals().size());
+			for (size_t i = 0; i < current_pop.get_individuals().size(); i++)
+				async_slots.set_fitness(i, current_pop.get_adjusted_fitness()[i]);
+			async_population_ready = true;
+		}
+
+		// adds the time since finished to the time the calling thread spent waiting at the evaluation barrier
+		static void add_idle_time(population_stats& stats, const std::chrono::steady_clock::time_point finished)
+		{
+			const auto idle = std::chrono::duration<double>(std::chrono::steady_clock::now() - finished).count();
+			auto old_idle = stats.evaluation_idle_time.load(std::memory_order_relaxed);
+			while (!stats.evaluation_idle_time.compare_exchange_weak(old_idle, old_idle + idle, std::memory_order_relaxed,
+																	std::memory_order_relaxed))
+			{}
+		}
+
+		// cumulative selection probabilities used by select_fitness_proportionate_t
+		void compute_normalized_fitness()
+		{
+			current_stats.normalized_fitness.clear();
+			double sum_of_prob = 0;
+			for (const auto fitness : current_pop.get_adjusted_fitness())
+			{
+				const auto prob = fitness / current_stats.overall_fitness;
+				current_stats.normalized_fitness.push_back(sum_of_prob + prob);
+				sum_of_prob += prob;
+			}
+		}
+
 		void evaluate_fitness_internal()
 		{
 			statistic_history.push_back(current_stats);
 			current_stats.clear();
-			thread_helper.evaluation_left.store(config.population_size, std::memory_order_release);
-			(*thread_execution_service)(0);
-
-			std::sort(current_pop.begin(), current_pop.end(), [](const auto& a, const auto& b) {
-				return a.fitness.adjusted_fitness > b.fitness.adjusted_fitness;
-			});
+			if (async_population_ready)
+			{
+				// every child was evaluated before it was placed, the population only has to be ranked again
+				if (config.subtree_pool != nullptr)
+				{
+					config.subtree_pool->begin_refill(*this);
+					config.subtree_pool->refill(*this);
+				}
+				const auto& adjusted_fitness = current_pop.get_adjusted_fitness();
+				double overall = 0;
+				double worst = std::numeric_limits<double>::max();
+				for (const auto fitness : adjusted_fitness)
+				{
+					overall += fitness;
+					worst = std::min(worst, fitness);
+				}
+				current_stats.overall_fitness = overall;
+				current_stats.worst_fitness = worst;
+				current_pop.rank_by_fitness(ranking_size());
+			} else if (current_pop_evaluated)
+			{
+				// already evaluated while it was being bred, only the ranking and statistics are left to finish
+				current_pop_evaluated = false;
+				current_stats.overall_fitness = next_stats.overall_fitness.load(std::memory_order_relaxed);
+				current_stats.worst_fitness = next_stats.worst_fitness.load(std::memory_order_relaxed);
+				current_stats.evaluation_time = next_stats.evaluation_time.load(std::memory_order_relaxed);
+				current_stats.evaluation_idle_time = next_stats.evaluation_idle_time.load(std::memory_order_relaxed);
+				current_pop.finish_ranking();
+			} else
+			{
+				// no thread can be using the pool at this point
+				if (config.subtree_pool != nullptr)
+					config.subtree_pool->begin_refill(*this);
+				current_pop.reset_fitness();
+				current_pop.begin_ranking(ranking_size(), evaluation_threads());
+				thread_helper.evaluation_left.store(config.population_size, std::memory_order_release);
+				// the worker threads are waiting for the evaluation service, so nothing can be taking work yet
+				balance_evaluation = config.balance_evaluation_cost && evaluation_threads() > 1;
+				if (balance_evaluation)
+				{
+					// bred populations were estimated by the threads which bred them, only a new population is estimated here
+					if (!current_pop_estimated)
+					{
+						evaluation_estimates.resize(config.population_size);
+						for (size_t i = 0; i < config.population_size; i++)
+							evaluation_estimates[i] = cost_model.estimate(current_pop.get_individuals()[i].tree);
+					}
+					evaluation_times.assign(config.population_size, 0);
+					thread_helper.work.reset(config.population_size, evaluation_estimates.data(), evaluation_threads());
+				} else
+					thread_helper.work.reset(config.population_size, evaluation_threads());
+				const auto start = std::chrono::steady_clock::now();
+				(*thread_execution_service)(0);
+				current_stats.evaluation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				current_pop.finish_ranking();
+				if (balance_evaluation)
+					cost_model.fit(current_pop, evaluation_estimates, evaluation_times);
+				if (async_steady_state)
+					prepare_async_population();
+			}
 
-			current_stats.best_fitness = current_pop.get_individuals()[0].fitness.adjusted_fitness;
-			current_stats.worst_fitness = current_pop.get_individuals()[current_pop.get_individuals().size() - 1].fitness.adjusted_fitness;
+			current_stats.best_fitness = current_pop.get_adjusted_fitness()[current_pop.get_ranking().front()];
 			current_stats.average_fitness = current_stats.overall_fitness / static_cast<double>(config.population_size);
 		}
 
@@ -1176,6 +1812,38 @@ namespace errors::serialization
 		std::atomic_uint64_t current_generation = 0;
 
 		std::atomic_bool fitness_should_exit = false;
+		// set by the evaluation setup if any of its selections walk the whole population in fitness order
+		bool full_ranking = false;
+
+		// estimated and measured cost of evaluating every individual of the current population, see prog_config_t::balance_evaluation_cost
+		bool balance_evaluation = false;
+		evaluation_cost_model_t cost_model;
+		tracked_vector<double> evaluation_estimates;
+		tracked_vector<double> evaluation_times;
+		// estimates of next_pop, made while it is bred
+		tracked_vector<double> next_estimates;
+		// whether the estimates of a population were made while it was bred
+		bool current_pop_estimated = false;
+		bool next_pop_estimated = false;
+
+		// whether children are evaluated as they are bred, see prog_config_t::evaluate_while_breeding. next_stats collects the statistics of
+		// next_pop until it becomes the current population
+		bool fused_evaluation = false;
+		bool current_pop_evaluated = false;
+		bool next_pop_evaluated = false;
+		population_stats next_stats{};
+
+		// see setup_async_steady_state_evaluation(), the population is ready once it has been evaluated and the slots hold its fitness
+		// children replace individuals of the current population, which is never swapped with the next one
+		bool steady_state = false;
+		bool async_steady_state = false;
+		bool async_population_ready = false;
+		concurrent_slots_t async_slots;
+		// victims of the current steady state generation, indexed like the children which replace them. see begin_replacement()
+		tracked_vector<size_t> replaced_indices;
+		claim_bitmap_t replacement_claims;
+		std::atomic<double> replaced_fitness = 0;
+		std::atomic_bool worst_replaced = false;
 
 		population_stats current_stats{};
 		tracked_vector<population_stats> statistic_history;
@@ -1187,13 +1855,21 @@ namespace errors::serialization
 			std::mutex thread_function_control{};
 			std::condition_variable thread_function_condition{};
 
+			// evaluation_left and next_gen_left flag which phases the next run of the service performs, the work itself is handed out by
+			// the scheduler
 			std::atomic_uint64_t evaluation_left = 0;
 			std::atomic_uint64_t next_gen_left = 0;
+			work_stealing_scheduler_t work;
+
+			// one-shot tasks run by execute_on_threads(), guarded by thread_function_control
+			const std::function<void(size_t)>* task = nullptr;
+			size_t task_epoch = 0;
+			size_t tasks_complete = 0;
 
 			std::atomic_bool lifetime_over = false;
-			blt::barrier_t barrier;
+			adaptive_barrier_t barrier;
 
-			explicit concurrency_storage(blt::size_t threads): barrier(threads, lifetime_over)
+			explicit concurrency_storage(blt::size_t threads): work(threads), barrier(threads, lifetime_over)
 			{}
 		} thread_helper{config.threads == 0 ? std::thread::hardware_concurrency() : config.threads};
 
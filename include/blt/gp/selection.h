@@ -51,33 +51,10 @@ namespace blt::gp
 
             if (config.elites > 0 && current_pop.get_individuals().size() >= config.elites)
             {
-                thread_local tracked_vector<std::pair<std::size_t, double>> values;
-                values.clear();
-
-                for (size_t i = 0; i < config.elites; i++)
-                    values.emplace_back(i, current_pop.get_individuals()[i].fitness.adjusted_fitness);
-
-                for (const auto& ind : blt::enumerate(current_pop.get_individuals()))
-                {
-                    for (size_t i = 0; i < config.elites; i++)
-                    {
-                        if (ind.second.fitness.adjusted_fitness >= values[i].second)
-                        {
-                            bool doesnt_contain = true;
-                            for (blt::size_t j = 0; j < config.elites; j++)
-                            {
-                                if (ind.first == values[j].first)
-                                    doesnt_contain = false;
-                            }
-                            if (doesnt_contain)
-                                values[i] = {ind.first, ind.second.fitness.adjusted_fitness};
-                            break;
-                        }
-                    }
-                }
-
+                const auto& ranking = current_pop.get_ranking();
+                BLT_ASSERT_MSG(ranking.size() >= config.elites, "Population has not been ranked for elitism!");
                 for (size_t i = 0; i < config.elites; i++)
-                    next_pop.get_individuals()[i].copy_fast(current_pop.get_individuals()[values[i].first].tree);
+                    next_pop.get_individuals()[i].share(current_pop.get_individuals()[ranking[i]].tree);
                 return config.elites;
             }
             return 0ul;
@@ -104,6 +81,15 @@ namespace blt::gp
         {
         }
 
+        /**
+         * Populations are only fully ranked by fitness when a selection asks for it, otherwise only the elites are ranked.
+         * @return true if select() needs the ranking of the whole population, see population_t::get_ranking()
+         */
+        [[nodiscard]] virtual bool requires_ranking() const
+        {
+            return false;
+        }
+
         virtual ~selection_t() = default;
     };
 
@@ -112,6 +98,11 @@ namespace blt::gp
     public:
         void pre_process(gp_program&, population_t&) override;
 
+        [[nodiscard]] bool requires_ranking() const override
+        {
+            return true;
+        }
+
         const tree_t& select(gp_program& program, const population_t& pop) override;
 
     private:
@@ -123,6 +114,11 @@ namespace blt::gp
     public:
         void pre_process(gp_program&, population_t&) override;
 
+        [[nodiscard]] bool requires_ranking() const override
+        {
+            return true;
+        }
+
         const tree_t& select(gp_program& program, const population_t& pop) override;
 
     private:
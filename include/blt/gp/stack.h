@@ -25,12 +25,20 @@
 #include <blt/std/allocator.h>
 #include <blt/meta/meta.h>
 #include <blt/gp/util/meta.h>
+#include <blt/gp/util/small_vector.h>
 #include <blt/gp/allocator.h>
+#include <blt/gp/arena.h>
 #include <utility>
 #include <cstdlib>
 #include <memory>
 #include <type_traits>
 #include <cstring>
+#include <algorithm>
+
+#ifndef BLT_GP_INLINE_STACK_BYTES
+// bytes a stack stores inside itself before allocating. off by default, see BLT_GP_INLINE_OPERATIONS
+#define BLT_GP_INLINE_STACK_BYTES 0
+#endif
 
 namespace blt::gp
 {
@@ -51,58 +59,109 @@ namespace blt::gp
      * You can configure this by setting `BLT_GP_MAX_ALIGNMENT` as a compiler definition but be aware it will increase memory requirements.
      * Setting `BLT_GP_MAX_ALIGNMENT` to lower than 8 is UB on x86-64 systems.
      * Consequently, all types have a minimum storage size of `BLT_GP_MAX_ALIGNMENT` (8) bytes, meaning a char, float, int, etc. will take `BLT_GP_MAX_ALIGNMENT` bytes
+     *
+     * Defining `BLT_GP_PACKED_VALUES` stores values at 4 byte alignment instead, so a float or int only takes 4 bytes. Types with a larger alignment,
+     * such as double, or with a drop function cannot be stored in this layout and fail to compile.
+     *
+     * Defining `BLT_GP_INLINE_STACK_BYTES` stores the first that many bytes inside the stack itself, so pointers into the stack are invalidated
+     * by moving it.
      */
-    class stack_allocator
+    class stack_allocator : detail::inline_buffer_t<detail::align_bytes(BLT_GP_INLINE_STACK_BYTES), detail::MAX_ALIGNMENT>
     {
+        using buffer_t = detail::inline_buffer_t<detail::align_bytes(BLT_GP_INLINE_STACK_BYTES), detail::MAX_ALIGNMENT>;
         constexpr static size_t PAGE_SIZE = 0x100;
-        using Allocator = aligned_allocator;
+        using Allocator = allocator_policy_t;
 
         static constexpr size_t align_bytes(const size_t size) noexcept
         {
-            return (size + (detail::MAX_ALIGNMENT - 1)) & ~(detail::MAX_ALIGNMENT - 1);
+            return detail::align_value_bytes(size);
         }
 
     public:
+        static constexpr size_t INLINE_SIZE = detail::align_bytes(BLT_GP_INLINE_STACK_BYTES);
+
         static Allocator& get_allocator();
 
         template <typename T>
         static constexpr size_t aligned_size() noexcept
         {
+            constexpr bool has_drop = blt::gp::detail::has_func_drop_v<detail::remove_cv_ref<T>>;
+            static_assert(alignof(std::decay_t<T>) <= detail::VALUE_ALIGNMENT, "Type alignment must not be greater than the value alignment!");
+            static_assert(!has_drop || alignof(std::atomic_uint64_t*) <= detail::VALUE_ALIGNMENT,
+                          "Types with a drop function need pointer aligned values!");
             const auto bytes = align_bytes(sizeof(std::decay_t<T>));
-            if constexpr (blt::gp::detail::has_func_drop_v<detail::remove_cv_ref<T>>)
+            if constexpr (has_drop)
                 return bytes + align_bytes(sizeof(std::atomic_uint64_t*));
             return bytes;
         }
 
         stack_allocator() = default;
 
+        /**
+         * Creates a stack which allocates from the provided arena instead of the heap, nullptr for the heap.
+         */
+        explicit stack_allocator(tree_arena_t* arena): arena_(arena)
+        {
+        }
+
+        // copies are always heap allocated
         stack_allocator(const stack_allocator& copy)
         {
-            if (copy.data_ == nullptr || copy.bytes_stored == 0)
+            if (copy.bytes_stored == 0)
                 return;
-            expand(copy.size_);
+            reserve(copy.bytes_stored);
             std::memcpy(data_, copy.data_, copy.bytes_stored);
             bytes_stored = copy.bytes_stored;
         }
 
-        stack_allocator(stack_allocator&& move) noexcept:
-            data_(std::exchange(move.data_, nullptr)), bytes_stored(std::exchange(move.bytes_stored, 0)), size_(std::exchange(move.size_, 0))
+        stack_allocator(stack_allocator&& move) noexcept: bytes_stored(std::exchange(move.bytes_stored, 0)), arena_(move.arena_)
         {
+            if (move.is_inline())
+            {
+                // an empty stack without inline storage has no buffer to copy from
+                if (bytes_stored > 0)
+                    std::memcpy(inline_data(), move.inline_data(), bytes_stored);
+            } else
+            {
+                data_ = std::exchange(move.data_, move.inline_data());
+                size_ = std::exchange(move.size_, INLINE_SIZE);
+            }
         }
 
         stack_allocator& operator=(const stack_allocator& copy) = delete;
 
         stack_allocator& operator=(stack_allocator&& move) noexcept
         {
-            data_ = std::exchange(move.data_, data_);
-            size_ = std::exchange(move.size_, size_);
-            bytes_stored = std::exchange(move.bytes_stored, bytes_stored);
+            swap(move);
             return *this;
         }
 
         ~stack_allocator()
         {
-            get_allocator().deallocate(data_, size_);
+            if (!is_inline() && arena_ == nullptr)
+                get_allocator().deallocate(data_, size_);
+        }
+
+        void swap(stack_allocator& other) noexcept
+        {
+            if (!is_inline() && !other.is_inline())
+            {
+                std::swap(data_, other.data_);
+                std::swap(size_, other.size_);
+            } else if (is_inline() && other.is_inline())
+                std::swap_ranges(inline_data(), inline_data() + std::max(bytes_stored, other.bytes_stored), other.inline_data());
+            else
+            {
+                // the inline bytes move into the buffer of the stack which has allocated, which takes over the allocation
+                auto& small = is_inline() ? *this : other;
+                auto& large = is_inline() ? other : *this;
+                if (small.bytes_stored > 0)
+                    std::memcpy(large.inline_data(), small.inline_data(), small.bytes_stored);
+                small.data_ = std::exchange(large.data_, large.inline_data());
+                small.size_ = std::exchange(large.size_, INLINE_SIZE);
+            }
+            std::swap(bytes_stored, other.bytes_stored);
+            std::swap(arena_, other.arena_);
         }
 
         void insert(const stack_allocator& stack)
@@ -158,7 +217,7 @@ namespace blt::gp
         {
             using DecayedT = std::decay_t<T>;
             static_assert(std::is_trivially_copyable_v<DecayedT>, "Type must be bitwise copyable!");
-            static_assert(alignof(DecayedT) <= detail::MAX_ALIGNMENT, "Type alignment must not be greater than the max alignment!");
+            static_assert(alignof(DecayedT) <= detail::VALUE_ALIGNMENT, "Type alignment must not be greater than the value alignment!");
             const auto ptr = static_cast<char*>(allocate_bytes_for_size(aligned_size<DecayedT>()));
             std::memcpy(ptr, &t, sizeof(DecayedT));
 
@@ -173,7 +232,7 @@ namespace blt::gp
         {
             using DecayedT = std::decay_t<T>;
             static_assert(std::is_trivially_copyable_v<DecayedT>, "Type must be bitwise copyable!");
-            static_assert(alignof(DecayedT) <= detail::MAX_ALIGNMENT, "Type alignment must not be greater than the max alignment!");
+            static_assert(alignof(DecayedT) <= detail::VALUE_ALIGNMENT, "Type alignment must not be greater than the value alignment!");
             constexpr auto size = aligned_size<DecayedT>();
 #if BLT_DEBUG_LEVEL > 0
             if (bytes_stored < size)
@@ -199,7 +258,7 @@ namespace blt::gp
         {
             using DecayedT = std::decay_t<T>;
             static_assert(std::is_trivially_copyable_v<DecayedT> && "Type must be bitwise copyable!");
-            static_assert(alignof(DecayedT) <= detail::MAX_ALIGNMENT && "Type alignment must not be greater than the max alignment!");
+            static_assert(alignof(DecayedT) <= detail::VALUE_ALIGNMENT && "Type alignment must not be greater than the value alignment!");
             return *reinterpret_cast<DecayedT*>(from(aligned_size<DecayedT>() + bytes));
         }
 
@@ -241,7 +300,7 @@ namespace blt::gp
             if (bytes_stored < bytes)
                 BLT_ABORT(("Not enough bytes in stack to pop " + std::to_string(bytes) + " bytes requested but " + std::to_string(bytes) +
                 " bytes stored!").c_str());
-            gp::detail::check_alignment(bytes);
+            gp::detail::check_alignment(bytes, "Invalid value alignment", detail::VALUE_ALIGNMENT);
 #endif
             bytes_stored -= bytes;
         }
@@ -253,7 +312,7 @@ namespace blt::gp
                 BLT_ABORT(
                 ("Not enough bytes in stack to transfer " + std::to_string(aligned_bytes) + " bytes requested but " + std::to_string(aligned_bytes) +
                     " bytes stored!").c_str());
-            gp::detail::check_alignment(aligned_bytes);
+            gp::detail::check_alignment(aligned_bytes, "Invalid value alignment", detail::VALUE_ALIGNMENT);
 #endif
             to.copy_from(*this, aligned_bytes);
             pop_bytes(aligned_bytes);
@@ -301,20 +360,81 @@ namespace blt::gp
             return data_;
         }
 
+        [[nodiscard]] tree_arena_t* get_arena() const
+        {
+            return arena_;
+        }
+
+        /**
+         * @return true while the stored bytes live inside the stack itself
+         */
+        [[nodiscard]] bool is_inline() const noexcept
+        {
+            return data_ == inline_data();
+        }
+
+        /**
+         * Moves the stored bytes into a buffer allocated from arena, or from the heap if arena is nullptr. The new buffer is only as large as
+         * the bytes stored, bytes which fit are moved inline instead.
+         */
+        void set_arena(tree_arena_t* arena)
+        {
+            if (arena == arena_)
+                return;
+            if (is_inline())
+            {
+                arena_ = arena;
+                return;
+            }
+            u8* new_data = inline_data();
+            size_t new_size = INLINE_SIZE;
+            if (bytes_stored > INLINE_SIZE)
+            {
+                new_data = static_cast<u8*>(arena != nullptr ? arena->allocate(bytes_stored) : get_allocator().allocate(bytes_stored));
+                new_size = bytes_stored;
+            }
+            if (bytes_stored > 0)
+                std::memcpy(new_data, data_, bytes_stored);
+            if (arena_ == nullptr)
+                get_allocator().deallocate(data_, size_);
+            data_ = new_data;
+            size_ = new_size;
+            arena_ = arena;
+        }
+
     private:
+        [[nodiscard]] u8* inline_data() noexcept
+        {
+            return buffer_t::inline_bytes();
+        }
+
+        [[nodiscard]] const u8* inline_data() const noexcept
+        {
+            return buffer_t::inline_bytes();
+        }
+
         void expand(const size_t bytes)
         {
-            //bytes = to_nearest_page_size(bytes);
-            expand_raw(bytes);
+            // grow geometrically, trees built up one push or copy at a time would otherwise reallocate on every call
+            expand_raw(detail::align_bytes(std::max(bytes, size_ + size_ / 2)));
         }
 
-        void expand_raw(const size_t bytes)
+        void expand_raw(size_t bytes)
         {
-            // auto aligned = detail::aligned_size(bytes);
-            const auto new_data = static_cast<u8*>(get_allocator().allocate(bytes));
+            u8* new_data;
+            if (arena_ != nullptr)
+                new_data = static_cast<u8*>(arena_->allocate(bytes));
+            else
+            {
+                // use the whole block the allocator hands back
+                bytes = Allocator::usable_size(bytes);
+                new_data = static_cast<u8*>(get_allocator().allocate(bytes));
+            }
             if (bytes_stored > 0)
                 std::memcpy(new_data, data_, bytes_stored);
-            get_allocator().deallocate(data_, size_);
+            // arena memory is reclaimed all at once when the arena is reset
+            if (!is_inline() && arena_ == nullptr)
+                get_allocator().deallocate(data_, size_);
             data_ = new_data;
             size_ = bytes;
         }
@@ -331,13 +451,13 @@ namespace blt::gp
                 return nullptr;
             size_t remaining_bytes = remainder();
             auto* pointer = static_cast<void*>(data_ + bytes_stored);
-            return std::align(gp::detail::MAX_ALIGNMENT, bytes, pointer, remaining_bytes);
+            return std::align(gp::detail::VALUE_ALIGNMENT, bytes, pointer, remaining_bytes);
         }
 
         void* allocate_bytes_for_size(const size_t aligned_bytes)
         {
 #if BLT_DEBUG_LEVEL > 0
-            gp::detail::check_alignment(aligned_bytes);
+            gp::detail::check_alignment(aligned_bytes, "Invalid value alignment", detail::VALUE_ALIGNMENT);
 #endif
             auto aligned_ptr = get_aligned_pointer(aligned_bytes);
             if (aligned_ptr == nullptr)
@@ -351,10 +471,11 @@ namespace blt::gp
             return aligned_ptr;
         }
 
-        u8* data_ = nullptr;
+        u8* data_ = inline_data();
         // place in the data_ array which has a free spot.
         size_t bytes_stored = 0;
-        size_t size_ = 0;
+        size_t size_ = INLINE_SIZE;
+        tree_arena_t* arena_ = nullptr;
     };
 
     template <size_t Size>
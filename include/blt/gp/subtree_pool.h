@@ -0,0 +1,189 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_SUBTREE_POOL_H
+#define BLT_GP_SUBTREE_POOL_H
+
+#include <blt/gp/fwdecl.h>
+#include <blt/gp/tree.h>
+#include <blt/gp/generators.h>
+#include <blt/meta/config_generator.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace blt::gp
+{
+    /**
+     * Pool of pre-generated random subtrees, bucketed by return type and depth range.
+     * The pool is refilled by worker threads once they run out of fitness evaluations to perform (or between phases when single threaded),
+     * which moves tree generation off the critical path of mutation. Mutation copies a pooled tree into the child using replace_subtree.
+     * If a bucket has been exhausted (or does not exist) the caller is expected to fall back to generating the tree itself.
+     *
+     * Note: like the mutation and crossover operators, the pool must outlive the program it is attached to. The pooled trees reference the
+     * program which generated them, so a pool belongs to the first program which refills it until that program is destroyed. Programs running
+     * at the same time, such as the islands of an island model, each need a pool of their own.
+     */
+    class subtree_pool_t
+    {
+    public:
+        enum class reuse_policy_t : u8
+        {
+            // every pooled tree is handed out once, then the bucket misses until it is refilled.
+            CONSUME,
+            // trees are handed out in order, each up to max_uses times.
+            CYCLE,
+            // trees are selected at random from the bucket. never misses once the bucket has been filled.
+            RANDOM
+        };
+
+        struct depth_range_t
+        {
+            size_t min_depth;
+            size_t max_depth;
+        };
+
+        struct config_t
+        {
+            // number of trees stored per (type, depth range) bucket. zero disables the pool.
+            size_t trees_per_bucket = 128;
+            // how many times a single tree can be handed out when using the CYCLE policy
+            size_t max_uses = 2;
+            reuse_policy_t reuse_policy = reuse_policy_t::CONSUME;
+            // depth ranges to generate trees for. these must match the depths requested by mutation exactly.
+            std::vector<depth_range_t> depth_ranges{{2, 6}};
+
+            std::reference_wrapper<tree_generator_t> generator;
+
+            BLT_MAKE_SETTER_LVALUE(size_t, trees_per_bucket);
+            BLT_MAKE_SETTER_LVALUE(size_t, max_uses);
+            BLT_MAKE_SETTER_LVALUE(reuse_policy_t, reuse_policy);
+
+            config_t& add_depth_range(const size_t min_depth, const size_t max_depth)
+            {
+                depth_ranges.push_back({min_depth, max_depth});
+                return *this;
+            }
+
+            config_t& clear_depth_ranges()
+            {
+                depth_ranges.clear();
+                return *this;
+            }
+
+            config_t(tree_generator_t& generator): generator(generator) // NOLINT
+            {
+            }
+
+            config_t();
+        };
+
+        struct stats_t
+        {
+            u64 hits;
+            u64 misses;
+            u64 trees_generated;
+        };
+
+        subtree_pool_t() = default;
+
+        explicit subtree_pool_t(config_t config): config(std::move(config))
+        {
+        }
+
+        /**
+         * Fetch a pooled tree of the provided type and depth range.
+         * This can be called concurrently from any number of threads, but not while the pool is being refilled.
+         * @return pointer to a tree which must only be copied from, or nullptr if the pool could not provide one.
+         */
+        [[nodiscard]] tree_t* acquire(gp_program& program, type_id type, size_t min_depth, size_t max_depth);
+
+        /**
+         * Prepares the pool for a refill, creating any missing buckets. Must be called while no other thread is using the pool.
+         * The first program to refill the pool becomes its owner, see clear().
+         */
+        void begin_refill(gp_program& program);
+
+        /**
+         * Refill buckets until there are none left to refill. Any number of threads can call this concurrently,
+         * buckets are claimed one at a time so the work is shared between whichever threads are idle.
+         */
+        void refill(gp_program& program);
+
+        /**
+         * Destroys all pooled trees if program owns the pool, after which the pool can be used by another program. Called by the program on
+         * destruction, as the trees reference it.
+         */
+        void clear(const gp_program& program);
+
+        /**
+         * @return the program the pooled trees were generated by, or nullptr if the pool has not been refilled since it was last cleared
+         */
+        [[nodiscard]] const gp_program* get_owner() const
+        {
+            return owner;
+        }
+
+        [[nodiscard]] stats_t get_stats() const
+        {
+            return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed), trees_generated.load(std::memory_order_relaxed)};
+        }
+
+        void reset_stats()
+        {
+            hits = 0;
+            misses = 0;
+            trees_generated = 0;
+        }
+
+        [[nodiscard]] const config_t& get_config() const
+        {
+            return config;
+        }
+
+    private:
+        struct bucket_t
+        {
+            type_id type;
+            depth_range_t depth;
+            tracked_vector<tree_t> trees;
+            std::atomic_uint64_t draws = 0;
+
+            bucket_t(const type_id type, const depth_range_t depth): type(type), depth(depth)
+            {
+            }
+        };
+
+        void refill_bucket(gp_program& program, bucket_t& bucket);
+
+        config_t config;
+        const gp_program* owner = nullptr;
+
+        std::vector<std::unique_ptr<bucket_t>> buckets;
+        // index by type id
+        std::vector<std::vector<bucket_t*>> buckets_by_type;
+
+        std::atomic_uint64_t refill_cursor = 0;
+
+        std::atomic_uint64_t hits = 0;
+        std::atomic_uint64_t misses = 0;
+        std::atomic_uint64_t trees_generated = 0;
+    };
+}
+
+#endif //BLT_GP_SUBTREE_POOL_H
@@ -21,10 +21,18 @@
 
 #include <blt/std/types.h>
 #include <blt/std/thread.h>
+#include <blt/std/assert.h>
+#include <blt/std/defines.h>
 #include <thread>
 #include <functional>
 #include <atomic>
+#include <memory>
+#include <optional>
 #include <type_traits>
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
 
 namespace blt::gp
 {
@@ -38,6 +46,280 @@ namespace blt::gp
         };
     }
 
+    /**
+     * Work stealing scheduler for splitting an index range between a fixed set of threads. reset() divides the range evenly between the
+     * threads, each thread then takes chunks from the front of its own part with next(). A thread which has run out of work steals the back
+     * half of the largest remaining part, so threads only contend on a shared cache line once they would otherwise be idle.
+     *
+     * reset() must not run concurrently with next(), a barrier between the two is enough. The work is complete once next() has returned
+     * false on every thread.
+     */
+    class work_stealing_scheduler_t
+    {
+    public:
+        explicit work_stealing_scheduler_t(size_t thread_count);
+
+        /**
+         * Splits [0, count) between the first active_threads threads. The other threads only steal.
+         */
+        void reset(size_t count, size_t active_threads);
+
+        void reset(const size_t count)
+        {
+            reset(count, thread_count);
+        }
+
+        /**
+         * Splits [0, count) between the first active_threads threads so every part has about the same total cost, where costs[i] is the cost
+         * of index i. Stealing still splits parts by the number of indices left.
+         */
+        void reset(size_t count, const double* costs, size_t active_threads);
+
+        /**
+         * Claims the next chunk of at most chunk_size indices for thread_index, stealing from another thread if its own part is empty.
+         * @return false once there is no work left anywhere
+         */
+        bool next(size_t thread_index, size_t chunk_size, size_t& begin, size_t& end);
+
+        /**
+         * Calls func(begin, end) for every chunk claimed by thread_index, until the range has been exhausted.
+         */
+        template <typename Func>
+        void for_each(const size_t thread_index, const size_t chunk_size, Func&& func)
+        {
+            size_t begin, end;
+            while (next(thread_index, chunk_size, begin, end))
+                func(begin, end);
+        }
+
+        [[nodiscard]] size_t get_thread_count() const
+        {
+            return thread_count;
+        }
+
+        // number of chunks taken from another thread since the last reset
+        [[nodiscard]] size_t get_steals() const
+        {
+            return steals.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // begin in the upper 32 bits, end in the lower, so both ends of a part are claimed with a single compare exchange
+        struct alignas(64) part_t
+        {
+            std::atomic_uint64_t range = 0;
+        };
+
+        static u64 pack(const u64 begin, const u64 end)
+        {
+            return (begin << 32) | end;
+        }
+
+        static size_t begin_of(const u64 range)
+        {
+            return range >> 32;
+        }
+
+        static size_t end_of(const u64 range)
+        {
+            return range & 0xFFFFFFFFul;
+        }
+
+        bool steal(size_t thread_index, size_t chunk_size, size_t& begin, size_t& end);
+
+        size_t thread_count;
+        std::unique_ptr<part_t[]> parts;
+        std::atomic_uint64_t steals = 0;
+    };
+
+    /**
+     * Barrier for a fixed set of threads which meet many times per generation. A waiting thread first spins, then yields, and only then parks
+     * on a futex (a condition variable where futexes are not available). Each thread adapts how long it spins to how long its recent waits
+     * took, so short waits never reach the kernel while long ones do not burn a core.
+     *
+     * wait() is split into arrive() and wait(thread_index, phase). A thread which has arrived can keep working on something that does not
+     * depend on the other threads and only wait once it needs them, but it must not arrive again before its phase has completed.
+     */
+    class adaptive_barrier_t
+    {
+    public:
+        using phase_t = u32;
+
+        explicit adaptive_barrier_t(size_t thread_count, std::optional<std::reference_wrapper<std::atomic_bool>> exit_cond = {});
+
+        /**
+         * Marks the calling thread as having reached the barrier, without waiting for the others.
+         * @return the phase to pass to wait(), which completes once every thread has arrived
+         */
+        phase_t arrive();
+
+        /**
+         * Blocks until the phase returned by arrive() has completed, or the exit condition is set. The time spent is added to thread_index.
+         */
+        void wait(size_t thread_index, phase_t phase);
+
+        void wait(const size_t thread_index)
+        {
+            wait(thread_index, arrive());
+        }
+
+        /**
+         * Releases every waiting thread. Only meant for shutting down, the exit condition must already be set so they do not wait again.
+         */
+        void notify_all();
+
+        // seconds thread_index has spent waiting since the last reset_wait_times()
+        [[nodiscard]] double get_wait_time(size_t thread_index) const;
+
+        [[nodiscard]] double get_total_wait_time() const;
+
+        // number of waits of thread_index which had to park since the last reset_wait_times()
+        [[nodiscard]] size_t get_parks(size_t thread_index) const;
+
+        // must not run concurrently with wait()
+        void reset_wait_times();
+
+        [[nodiscard]] size_t get_thread_count() const
+        {
+            return thread_count;
+        }
+
+    private:
+        // only written by the owning thread, so waiting threads do not share cache lines
+        struct alignas(64) waiter_t
+        {
+            std::atomic_uint64_t wait_ns = 0;
+            std::atomic_uint64_t parks = 0;
+            u32 spin_limit = 0;
+        };
+
+        [[nodiscard]] bool released(phase_t phase) const;
+
+        void park(phase_t phase);
+
+        void wake();
+
+        size_t thread_count;
+        u32 max_spin;
+        std::optional<std::reference_wrapper<std::atomic_bool>> exit_cond;
+        std::unique_ptr<waiter_t[]> waiters;
+        alignas(64) std::atomic<phase_t> phase = 0;
+        alignas(64) std::atomic_uint64_t arrived = 0;
+        std::atomic_uint64_t parked = 0;
+#ifndef __linux__
+        std::mutex park_mutex;
+        std::condition_variable park_condition;
+#endif
+    };
+
+    /**
+     * One atomic bit per index, which threads claim to make sure no two of them pick the same index.
+     */
+    class claim_bitmap_t
+    {
+    public:
+        // must not run concurrently with anything else
+        void reset(size_t count);
+
+        /**
+         * @return false if another thread has already claimed the index
+         */
+        bool try_claim(const size_t index)
+        {
+            const auto bit = u64(1) << (index % 64);
+            return !(words[index / 64].fetch_or(bit, std::memory_order_relaxed) & bit);
+        }
+
+        void release(const size_t index)
+        {
+            words[index / 64].fetch_and(~(u64(1) << (index % 64)), std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool is_claimed(const size_t index) const
+        {
+            return words[index / 64].load(std::memory_order_relaxed) & (u64(1) << (index % 64));
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return count;
+        }
+
+    private:
+        size_t count = 0;
+        size_t word_count = 0;
+        std::unique_ptr<std::atomic_uint64_t[]> words;
+    };
+
+    /**
+     * Per individual synchronisation for a population which is bred from and replaced into at the same time. Every slot has a reader writer
+     * spin lock, and a copy of the individual's adjusted fitness which can be read without taking the lock.
+     *
+     * A slot is claimed before it is replaced, so two threads never pick the same one. Claiming does not block readers, the old individual can
+     * still be copied until the claiming thread calls lock_claimed() to write the replacement.
+     */
+    class concurrent_slots_t
+    {
+    public:
+        // must not run concurrently with anything else
+        void reset(size_t count);
+
+        void lock_shared(size_t slot);
+
+        void unlock_shared(const size_t slot)
+        {
+            slots[slot].state.fetch_sub(1, std::memory_order_release);
+        }
+
+        /**
+         * @return false if another thread has already claimed the slot
+         */
+        bool try_claim(size_t slot);
+
+        [[nodiscard]] bool is_claimed(const size_t slot) const
+        {
+            return slots[slot].state.load(std::memory_order_relaxed) & CLAIMED;
+        }
+
+        // waits for the readers of a slot claimed by the calling thread to finish, after which nobody else can read it until unlock()
+        void lock_claimed(size_t slot);
+
+        // releases the lock taken by lock_claimed() together with the claim, or a claim which was never locked
+        void unlock(const size_t slot)
+        {
+            slots[slot].state.store(0, std::memory_order_release);
+        }
+
+        [[nodiscard]] double get_fitness(const size_t slot) const
+        {
+            return slots[slot].fitness.load(std::memory_order_relaxed);
+        }
+
+        void set_fitness(const size_t slot, const double fitness)
+        {
+            slots[slot].fitness.store(fitness, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return count;
+        }
+
+    private:
+        static constexpr u32 WRITER = 1u << 31;
+        static constexpr u32 CLAIMED = 1u << 30;
+
+        // the lower bits of state count the readers
+        struct slot_t
+        {
+            std::atomic_uint32_t state = 0;
+            std::atomic<double> fitness = 0;
+        };
+
+        size_t count = 0;
+        std::unique_ptr<slot_t[]> slots;
+    };
+
     template <typename EnumId>
     class task_builder_t;
 
@@ -147,7 +429,8 @@ namespace blt::gp
 
     public:
         explicit thread_manager_t(const size_t thread_count, std::function<void(barrier_t&, EnumId, size_t)> task_func,
-                                  const bool will_main_block = true): barrier(thread_count), will_main_block(will_main_block)
+                                  const bool will_main_block = true): barrier(thread_count), will_main_block(will_main_block),
+                                                                      scheduler(thread_count)
         {
             thread_callable = [this, task_func = std::move(task_func)](const size_t thread_index)
             {
@@ -200,6 +483,15 @@ namespace blt::gp
             }
         }
 
+        /**
+         * Scheduler shared by every thread of this manager. A task can reset it in its single function and drain it in its parallel function
+         * to split a range of work between the threads.
+         */
+        work_stealing_scheduler_t& get_scheduler()
+        {
+            return scheduler;
+        }
+
         bool has_tasks_left()
         {
             if (will_main_block)
@@ -233,6 +525,7 @@ namespace blt::gp
         std::atomic_uint64_t tasks_remaining = 0;
         std::vector<std::thread> threads;
         std::mutex task_lock;
+        work_stealing_scheduler_t scheduler;
 
         std::function<void(size_t)> thread_callable;
     };
@@ -187,6 +187,8 @@ namespace blt::gp
             blt::size_t replacement_max_depth = 6;
 
             std::reference_wrapper<tree_generator_t> generator;
+            // optional pool of pre-generated subtrees. if the pool cannot provide a tree the generator above is used instead.
+            subtree_pool_t* subtree_pool = nullptr;
 
             config_t(tree_generator_t& generator): generator(generator) // NOLINT
             {
@@ -209,6 +211,12 @@ namespace blt::gp
         virtual ~mutation_t() = default;
 
     protected:
+        /**
+         * Get a random tree of the provided type to use as a replacement. The returned tree is either from the subtree pool or thread local,
+         * so it must be copied into the child before the next call.
+         */
+        [[nodiscard]] tree_t& get_replacement_tree(gp_program& program, type_id type) const;
+
         config_t config;
     };
 
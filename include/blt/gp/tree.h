@@ -26,7 +26,10 @@
 #include <blt/std/types.h>
 #include <blt/fs/fwddecl.h>
 
+#include <algorithm>
 #include <utility>
+#include <limits>
+#include <memory>
 #include <stack>
 
 namespace blt::gp
@@ -56,47 +59,60 @@ namespace blt::gp
 
     static_assert(sizeof(operator_special_flags) == 1, "Size of operator flags struct is expected to be 1 byte!");
 
+    /**
+     * Packed into 8 bytes, as every node of every tree is stored (and copied between generations) as one of these.
+     * The limits are checked by the operator_builder when operators are registered.
+     */
     struct op_container_t
     {
+        // largest operator id + 1 which can be stored in a container
+        static constexpr size_t max_operators = std::numeric_limits<u32>::max();
+        // largest (aligned) type size which can be stored in a container
+        static constexpr size_t max_type_size = (1ul << 29) - 1;
+
         op_container_t(const size_t type_size, const operator_id id, const bool is_value, const operator_special_flags flags):
-            m_type_size(type_size), m_id(id), m_is_value(is_value), m_flags(flags)
+            m_id(static_cast<u32>(id)), m_type_size(static_cast<u32>(type_size)), m_is_value(is_value), m_ephemeral(flags.is_ephemeral()),
+            m_ephemeral_drop(flags.has_ephemeral_drop())
         {
         }
 
-        [[nodiscard]] auto type_size() const
+        [[nodiscard]] size_t type_size() const
         {
             return m_type_size;
         }
 
-        [[nodiscard]] auto id() const
+        [[nodiscard]] operator_id id() const
         {
-            return m_id;
+            return operator_id{m_id};
         }
 
-        [[nodiscard]] auto is_value() const
+        [[nodiscard]] bool is_value() const
         {
             return m_is_value;
         }
 
         [[nodiscard]] bool has_ephemeral_drop() const
         {
-            return m_flags.has_ephemeral_drop();
+            return m_ephemeral_drop;
         }
 
         [[nodiscard]] operator_special_flags get_flags() const
         {
-            return m_flags;
+            return operator_special_flags{static_cast<bool>(m_ephemeral), static_cast<bool>(m_ephemeral_drop)};
         }
 
         friend bool operator==(const op_container_t& a, const op_container_t& b);
 
     private:
-        size_t m_type_size;
-        operator_id m_id;
-        bool m_is_value;
-        operator_special_flags m_flags;
+        u32 m_id;
+        u32 m_type_size : 29;
+        u32 m_is_value : 1;
+        u32 m_ephemeral : 1;
+        u32 m_ephemeral_drop : 1;
     };
 
+    static_assert(sizeof(op_container_t) == 8, "Size of op container is expected to be 8 bytes!");
+
     class evaluation_context
     {
     public:
@@ -260,6 +276,13 @@ namespace blt::gp
         {
         }
 
+        /**
+         * Creates a tree whose operations and values are allocated from arena. Copies of the tree are heap allocated.
+         */
+        tree_t(gp_program& program, tree_arena_t* arena): operations(arena_allocator_t<op_container_t>{arena}), values(arena), m_program(&program)
+        {
+        }
+
         tree_t(const tree_t& copy): m_program(copy.m_program)
         {
             copy_fast(copy);
@@ -284,6 +307,13 @@ namespace blt::gp
         {
             if (this == &copy)
                 return;
+            if (m_shared != nullptr)
+                release_shared(false);
+            if (copy.m_shared != nullptr)
+            {
+                copy_fast(*copy.m_shared);
+                return;
+            }
 
             operations.reserve(copy.operations.size());
 
@@ -341,10 +371,55 @@ namespace blt::gp
 
         void clear(gp_program& program);
 
+        /**
+         * Copies source into this tree like copy_fast(), but if source's storage is shareable (see make_shareable()) it is referenced
+         * instead of copied. The storage is only copied once this tree is modified.
+         */
+        void share(const tree_t& source);
+
+        /**
+         * Moves the storage of this tree into a reference counted block, which trees copied from this one with share() point to.
+         * The block is immutable, this tree keeps reading from it until it is modified. Arena backed trees are left as they are,
+         * as their storage does not outlive the arena.
+         */
+        void make_shareable();
+
+        [[nodiscard]] bool is_shared() const
+        {
+            return m_shared != nullptr;
+        }
+
+        /**
+         * @return true if both the operations and values of this tree are stored inside the tree object, see BLT_GP_INLINE_OPERATIONS
+         * and BLT_GP_INLINE_STACK_BYTES. Without inline storage this is only true for trees which have not allocated.
+         */
+        [[nodiscard]] bool is_inline() const
+        {
+            const auto& tree = storage();
+            return tree.operations.is_inline() && tree.values.is_inline();
+        }
+
+        /**
+         * Clears the tree and releases its buffers. Arena buffers are simply dropped, this must be called on every tree allocated from an
+         * arena before the arena is reset.
+         */
+        void clear_storage();
+
+        /**
+         * Moves the contents of this tree into buffers allocated from arena, or from the heap if arena is nullptr.
+         */
+        void set_arena(tree_arena_t* arena);
+
+        [[nodiscard]] tree_arena_t* get_arena() const
+        {
+            return values.get_arena();
+        }
+
         void insert_operator(size_t index, const op_container_t& container);
 
         void insert_operator(const op_container_t& container)
         {
+            detach();
             operations.emplace_back(container);
             handle_operator_inserted(operations.back());
         }
@@ -352,6 +427,7 @@ namespace blt::gp
         template <typename... Args>
         void emplace_operator(Args&&... args)
         {
+            detach();
             operations.emplace_back(std::forward<Args>(args)...);
             handle_operator_inserted(operations.back());
         }
@@ -395,7 +471,7 @@ namespace blt::gp
                  * @param operators vector for storing subtree operators
                  * @param stack stack for storing subtree values
                  */
-        void copy_subtree(subtree_point_t point, ptrdiff_t extent, tracked_vector<op_container_t>& operators, stack_allocator& stack);
+        void copy_subtree(subtree_point_t point, ptrdiff_t extent, op_vector_t& operators, stack_allocator& stack);
 
         /**
          * Copies the subtree found at point into the provided out params
@@ -403,13 +479,14 @@ namespace blt::gp
          * @param operators vector for storing subtree operators
          * @param stack stack for storing subtree values
          */
-        void copy_subtree(const subtree_point_t point, tracked_vector<op_container_t>& operators, stack_allocator& stack)
+        void copy_subtree(const subtree_point_t point, op_vector_t& operators, stack_allocator& stack)
         {
             copy_subtree(point, find_endpoint(point.pos), operators, stack);
         }
 
         void copy_subtree(const subtree_point_t point, const ptrdiff_t extent, tree_t& out_tree)
         {
+            out_tree.detach();
             copy_subtree(point, extent, out_tree.operations, out_tree.values);
         }
 
@@ -507,7 +584,7 @@ namespace blt::gp
         {
             auto& ctx = evaluate(context);
             auto val = ctx.values.template from<T>(0);
-            evaluation_ref<T> ref{operations.front().get_flags().is_ephemeral(), val, ctx};
+            evaluation_ref<T> ref{storage().operations.front().get_flags().is_ephemeral(), val, ctx};
             return ref.get();
         }
 
@@ -521,7 +598,7 @@ namespace blt::gp
         {
             auto& ctx = evaluate();
             auto val = ctx.values.from<T>(0);
-            evaluation_ref<T> ref{operations.front().get_flags().is_ephemeral(), val, ctx};
+            evaluation_ref<T> ref{storage().operations.front().get_flags().is_ephemeral(), val, ctx};
             return ref.get();
         }
 
@@ -534,7 +611,7 @@ namespace blt::gp
         {
             auto& ctx = evaluate(context);
             auto& val = ctx.values.template from<T>(0);
-            return evaluation_ref<T>{operations.front().get_flags().is_ephemeral(), val, ctx};
+            return evaluation_ref<T>{storage().operations.front().get_flags().is_ephemeral(), val, ctx};
         }
 
         /**
@@ -546,7 +623,7 @@ namespace blt::gp
         {
             auto& ctx = evaluate();
             auto& val = ctx.values.from<T>(0);
-            return evaluation_ref<T>{operations.front().get_flags().is_ephemeral(), val, ctx};
+            return evaluation_ref<T>{storage().operations.front().get_flags().is_ephemeral(), val, ctx};
         }
 
         void print(std::ostream& out, bool print_literals = true, bool pretty_indent = false, bool include_types = false,
@@ -573,28 +650,39 @@ namespace blt::gp
 
         [[nodiscard]] size_t total_value_bytes(const size_t begin, const size_t end) const
         {
-            return total_value_bytes(operations.begin() + static_cast<ptrdiff_t>(begin),
-                                     operations.begin() + static_cast<ptrdiff_t>(end));
+            const auto& ops = storage().operations;
+            return total_value_bytes(ops.begin() + static_cast<ptrdiff_t>(begin), ops.begin() + static_cast<ptrdiff_t>(end));
         }
 
         [[nodiscard]] size_t total_value_bytes(const size_t begin) const
         {
-            return total_value_bytes(operations.begin() + static_cast<ptrdiff_t>(begin), operations.end());
+            const auto& ops = storage().operations;
+            return total_value_bytes(ops.begin() + static_cast<ptrdiff_t>(begin), ops.end());
         }
 
         [[nodiscard]] size_t total_value_bytes() const
         {
-            return total_value_bytes(operations.begin(), operations.end());
+            const auto& ops = storage().operations;
+            return total_value_bytes(ops.begin(), ops.end());
         }
 
         [[nodiscard]] size_t size() const
         {
-            return operations.size();
+            return storage().operations.size();
         }
 
         [[nodiscard]] const op_container_t& get_operator(const size_t point) const
         {
-            return operations[point];
+            return storage().operations[point];
+        }
+
+        /**
+         * The tree holding this tree's operations and values, which is the shared block if the storage is shared.
+         * Everything reading the storage of a tree which may be shared must go through this.
+         */
+        [[nodiscard]] const tree_t& storage() const
+        {
+            return m_shared != nullptr ? *m_shared : *this;
         }
 
         [[nodiscard]] subtree_point_t subtree_from_point(ptrdiff_t point) const;
@@ -647,6 +735,11 @@ namespace blt::gp
 
         static tree_t& get_thread_local(gp_program& program);
 
+        /**
+         * Hash of the operators making up this tree. Consistent with operator==, so values stored in the tree are not considered.
+         */
+        [[nodiscard]] size_t structural_hash() const;
+
         friend bool operator==(const tree_t& a, const tree_t& b);
 
         friend bool operator!=(const tree_t& a, const tree_t& b)
@@ -655,6 +748,18 @@ namespace blt::gp
         }
 
     private:
+        // gives this tree its own copy of the storage, must be called before a shared tree is modified
+        void detach()
+        {
+            if (m_shared != nullptr)
+                release_shared(true);
+        }
+
+        /**
+         * Stops sharing storage. If this is the last tree referencing it, the storage is taken back, otherwise it is copied if copy_contents is set.
+         */
+        void release_shared(bool copy_contents);
+
         void handle_operator_inserted(const op_container_t& op);
 
         void handle_ptr_empty(const mem::pointer_storage<std::atomic_uint64_t>& ptr, u8* data, operator_id id) const;
@@ -694,9 +799,12 @@ namespace blt::gp
 
         [[nodiscard]] evaluation_context& evaluate(void* ptr) const;
 
-        tracked_vector<op_container_t> operations;
+        // empty while the storage is shared
+        op_vector_t operations;
         stack_allocator values;
         gp_program* m_program;
+        // immutable storage shared with other trees, see share()
+        std::shared_ptr<tree_t> m_shared;
 
         /*
          * Static members
@@ -775,17 +883,46 @@ namespace blt::gp
         }
     };
 
+    /**
+     * Fitness of an individual, referencing the fitness arrays of the population it is stored in.
+     */
+    struct fitness_ref_t
+    {
+        double& raw_fitness;
+        double& standardized_fitness;
+        double& adjusted_fitness;
+        i64& hits;
+
+        fitness_ref_t& operator=(const fitness_t& fitness)
+        {
+            raw_fitness = fitness.raw_fitness;
+            standardized_fitness = fitness.standardized_fitness;
+            adjusted_fitness = fitness.adjusted_fitness;
+            hits = fitness.hits;
+            return *this;
+        }
+
+        operator fitness_t() const // NOLINT
+        {
+            return {raw_fitness, standardized_fitness, adjusted_fitness, hits};
+        }
+    };
+
+    /**
+     * The fitness of an individual is stored by its population, see population_t::get_fitness().
+     */
     struct individual_t
     {
         tree_t tree;
-        fitness_t fitness;
 
         void copy_fast(const tree_t& copy)
         {
-            // fast copy of the tree
             tree.copy_fast(copy);
-            // reset fitness
-            fitness = {};
+        }
+
+        void share(const tree_t& source)
+        {
+            tree.share(source);
         }
 
         individual_t() = delete;
@@ -814,6 +951,15 @@ namespace blt::gp
         }
     };
 
+    /**
+     * View of an individual stored in a population, made of its tree and its fitness.
+     */
+    struct individual_ref_t
+    {
+        tree_t& tree;
+        fitness_ref_t fitness;
+    };
+
     class population_t
     {
     public:
@@ -908,20 +1054,192 @@ namespace blt::gp
         void clear()
         {
             individuals.clear();
+            raw_fitness.clear();
+            standardized_fitness.clear();
+            adjusted_fitness.clear();
+            hits.clear();
+            ranking.clear();
+        }
+
+        /**
+         * Fitness values are stored in one array per field, indexed like the individuals, so selection and statistics only touch the
+         * values they compare. The arrays are only valid once reset_fitness() has been called for the current individuals.
+         */
+        [[nodiscard]] fitness_ref_t get_fitness(const size_t index)
+        {
+            return {raw_fitness[index], standardized_fitness[index], adjusted_fitness[index], hits[index]};
+        }
+
+        [[nodiscard]] fitness_t get_fitness(const size_t index) const
+        {
+            return {raw_fitness[index], standardized_fitness[index], adjusted_fitness[index], hits[index]};
+        }
+
+        void set_fitness(const size_t index, const fitness_t& fitness)
+        {
+            raw_fitness[index] = fitness.raw_fitness;
+            standardized_fitness[index] = fitness.standardized_fitness;
+            adjusted_fitness[index] = fitness.adjusted_fitness;
+            hits[index] = fitness.hits;
+        }
+
+        [[nodiscard]] const tracked_vector<double>& get_raw_fitness() const
+        {
+            return raw_fitness;
+        }
+
+        [[nodiscard]] const tracked_vector<double>& get_standardized_fitness() const
+        {
+            return standardized_fitness;
+        }
+
+        [[nodiscard]] const tracked_vector<double>& get_adjusted_fitness() const
+        {
+            return adjusted_fitness;
+        }
+
+        [[nodiscard]] const tracked_vector<i64>& get_hits() const
+        {
+            return hits;
+        }
+
+        [[nodiscard]] individual_ref_t get_individual(const size_t index)
+        {
+            return {individuals[index].tree, get_fitness(index)};
+        }
+
+        /**
+         * Index of a tree belonging to this population, such as one returned by a selection operator.
+         */
+        [[nodiscard]] size_t index_of(const tree_t& tree) const
+        {
+            const auto offset = reinterpret_cast<const char*>(&tree) - reinterpret_cast<const char*>(&individuals.front().tree);
+            const auto index = static_cast<size_t>(offset) / sizeof(individual_t);
+            BLT_ASSERT_MSG(offset >= 0 && index < individuals.size() && &individuals[index].tree == &tree, "Tree is not part of this population!");
+            return index;
+        }
+
+        /**
+         * Resizes the fitness arrays to the number of individuals and zeroes every value.
+         */
+        void reset_fitness();
+
+        /**
+         * Indices of the individuals ordered from the largest adjusted fitness to the smallest, ties broken by index. Individuals are never
+         * moved by ranking, so this may only contain the best few, see rank_by_fitness().
+         */
+        [[nodiscard]] const tracked_vector<size_t>& get_ranking() const
+        {
+            return ranking;
+        }
+
+        /**
+         * Ranks the best count individuals on the calling thread, or the whole population if count is at least its size.
+         */
+        void rank_by_fitness(size_t count);
+
+        /**
+         * Ranking split over thread_count threads. Every thread calls rank_slice() with its id, then merge_ranked_slices() with steps of
+         * 1, 2, 4, ... while step < thread_count, with all threads synchronized before each call. finish_ranking() is called by a single
+         * thread once every merge is done. The result is identical for any number of threads.
+         */
+        void begin_ranking(size_t count, size_t thread_count);
+
+        void rank_slice(size_t thread_id);
+
+        void merge_ranked_slices(size_t thread_id, size_t step);
+
+        void finish_ranking();
+
+        /**
+         * Ranks the population again after the fitness of the changed individuals has been replaced. A full ranking is updated by merging
+         * the changed individuals back into it, a partial ranking is redone with rank_by_fitness().
+         */
+        void update_ranking(const tracked_vector<size_t>& changed);
+
+        /**
+         * Moves every tree of this population into an arena owned by the population. Trees copied into the population afterwards are
+         * allocated from the arena as well, sequentially per thread, so the population is laid out contiguously in memory.
+         * Arena memory is only reclaimed by reset_arena(), which should be called before refilling the population.
+         */
+        void enable_arena(size_t block_size = tree_arena_t::DEFAULT_BLOCK_SIZE);
+
+        /**
+         * Moves every tree back onto the heap and frees the arena. Used when trees are replaced one at a time, since the arena would only
+         * ever grow.
+         */
+        void disable_arena();
+
+        /**
+         * Makes the storage of every tree shareable, so trees copied out of this population with tree_t::share() reference it instead of
+         * copying it. See tree_t::make_shareable().
+         */
+        void make_shareable();
+
+        /**
+         * Clears every tree and resets the arena. Does nothing if the arena is not enabled.
+         */
+        void reset_arena();
+
+        [[nodiscard]] tree_arena_t* get_arena() const
+        {
+            return arena.get();
         }
 
         population_t() = default;
 
-        population_t(const population_t&) = default;
+        // copies are heap allocated, the arena is not shared
+        population_t(const population_t& copy): individuals(copy.individuals), raw_fitness(copy.raw_fitness),
+                                                standardized_fitness(copy.standardized_fitness), adjusted_fitness(copy.adjusted_fitness),
+                                                hits(copy.hits), ranking(copy.ranking)
+        {
+        }
 
         population_t(population_t&&) = default;
 
         population_t& operator=(const population_t&) = delete;
 
-        population_t& operator=(population_t&&) = default;
+        population_t& operator=(population_t&& move) noexcept
+        {
+            // trees must be released before the arena they were allocated from
+            individuals = std::move(move.individuals);
+            arena = std::move(move.arena);
+            raw_fitness = std::move(move.raw_fitness);
+            standardized_fitness = std::move(move.standardized_fitness);
+            adjusted_fitness = std::move(move.adjusted_fitness);
+            hits = std::move(move.hits);
+            ranking = std::move(move.ranking);
+            return *this;
+        }
 
     private:
+        // declared before the individuals so it outlives them
+        std::unique_ptr<tree_arena_t> arena;
         tracked_vector<individual_t> individuals;
+        tracked_vector<double> raw_fitness;
+        tracked_vector<double> standardized_fitness;
+        tracked_vector<double> adjusted_fitness;
+        tracked_vector<i64> hits;
+        tracked_vector<size_t> ranking;
+        // number of individuals being ranked and the number of slices the ranking is split into
+        size_t rank_count = 0;
+        size_t rank_slices = 1;
+
+        [[nodiscard]] bool ranks_before(const size_t a, const size_t b) const
+        {
+            return adjusted_fitness[a] > adjusted_fitness[b] || (adjusted_fitness[a] == adjusted_fitness[b] && a < b);
+        }
+
+        [[nodiscard]] size_t slice_begin(const size_t slice) const
+        {
+            return individuals.size() * slice / rank_slices;
+        }
+
+        [[nodiscard]] size_t ranked_length(const size_t first_slice, const size_t slice_count) const
+        {
+            const auto last_slice = std::min(first_slice + slice_count, rank_slices);
+            return std::min(rank_count, slice_begin(last_slice) - slice_begin(first_slice));
+        }
     };
 }
 
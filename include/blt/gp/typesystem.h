@@ -27,6 +27,9 @@
 #include <blt/gp/fwdecl.h>
 #include <blt/gp/stack.h>
 #include <random>
+#include <atomic>
+#include <limits>
+#include <optional>
 
 namespace blt::gp
 {
@@ -82,6 +85,22 @@ namespace blt::gp
         bool has_ephemeral_drop_ = false;
     };
 
+    namespace detail
+    {
+        inline std::atomic_size_t next_static_type_index = 0;
+
+        /**
+         * Process wide index for T, assigned the first time it is requested. Lets the type_provider map C++ types to type ids
+         * with a single vector lookup, instead of hashing the type's name.
+         */
+        template <typename T>
+        size_t static_type_index()
+        {
+            static const size_t index = next_static_type_index.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+    }
+
     /**
      * Is a provider for the set of types possible in a GP program
      * also provides a set of functions for converting between C++ types and BLT GP types
@@ -96,46 +115,67 @@ namespace blt::gp
         {
             if (has_type<T>())
                 return;
+            const auto index = detail::static_type_index<T>();
             auto t = type::make_type<T>(types.size());
-            types.insert({blt::type_string_raw<T>(), t});
-            types_from_id[t.id()] = t;
+            if (index >= ids_by_static_index.size())
+                ids_by_static_index.resize(index + 1, no_type);
+            ids_by_static_index[index] = t.id();
+            ids_by_name.insert({std::string{t.name()}, t.id()});
+            types.push_back(t);
         }
 
         template <typename T>
-        type get_type()
+        [[nodiscard]] const type& get_type() const
         {
-            return types[blt::type_string_raw<T>()];
+            BLT_ASSERT(has_type<T>() && "Type has not been registered with this program!");
+            return types[ids_by_static_index[detail::static_type_index<T>()]];
         }
 
         template <typename T>
-        bool has_type()
+        [[nodiscard]] bool has_type() const
         {
-            return types.find(blt::type_string_raw<T>()) != types.end();
+            const auto index = detail::static_type_index<T>();
+            return index < ids_by_static_index.size() && ids_by_static_index[index] != no_type;
         }
 
-        type get_type(type_id id)
+        [[nodiscard]] const type& get_type(const type_id id) const
         {
-            return types_from_id[id];
+            return types[id];
         }
 
         /**
-         * This function is slow btw
-         * @param engine
-         * @return
+         * Only meant for naming and checking serialized data, use get_type<T>() otherwise.
          */
-        type select_type(std::mt19937_64& engine)
+        [[nodiscard]] std::optional<type_id> find_type(const std::string& name) const
+        {
+            const auto it = ids_by_name.find(name);
+            if (it == ids_by_name.end())
+                return {};
+            return it->second;
+        }
+
+        /**
+         * @return number of registered types. type ids are always in the range [0, size())
+         */
+        [[nodiscard]] size_t size() const
+        {
+            return types.size();
+        }
+
+        [[nodiscard]] const type& select_type(std::mt19937_64& engine) const
         {
             std::uniform_int_distribution dist(0ul, types.size() - 1);
-            auto offset = dist(engine);
-            auto itr = types.begin();
-            for ([[maybe_unused]] auto _ : blt::range(0ul, offset))
-                itr = itr++;
-            return itr->second;
+            return types[dist(engine)];
         }
 
     private:
-        hashmap_t<std::string, type> types;
-        expanding_buffer<type> types_from_id;
+        static constexpr u64 no_type = std::numeric_limits<u64>::max();
+
+        // indexed from TYPE ID
+        tracked_vector<type> types;
+        // indexed from detail::static_type_index<T>()
+        tracked_vector<u64> ids_by_static_index;
+        hashmap_t<std::string, type_id> ids_by_name;
     };
 }
 
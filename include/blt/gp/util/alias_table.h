@@ -0,0 +1,135 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_UTIL_ALIAS_TABLE_H
+#define BLT_GP_UTIL_ALIAS_TABLE_H
+
+#include <blt/gp/allocator.h>
+#include <blt/gp/typesystem.h>
+#include <blt/gp/random.h>
+#include <blt/logging/logging.h>
+
+namespace blt::gp
+{
+    /**
+     * Walker / Vose alias table used for weighted selection of operators in O(1) per draw.
+     * If every weight is the same the table degrades into a plain uniform selection, which only requires a single random number.
+     */
+    class alias_table_t
+    {
+    public:
+        alias_table_t() = default;
+
+        alias_table_t(const tracked_vector<operator_id>& operators, const tracked_vector<double>& weights_by_operator)
+        {
+            build(operators, weights_by_operator);
+        }
+
+        /**
+         * @param operators operators which can be selected from this table
+         * @param weights_by_operator weight of every operator in the program, indexed by operator id
+         */
+        void build(const tracked_vector<operator_id>& operators, const tracked_vector<double>& weights_by_operator)
+        {
+            items = operators;
+            probability.clear();
+            alias.clear();
+            uniform = true;
+            if (items.empty())
+                return;
+
+            double total = 0;
+            for (const auto& op : items)
+            {
+                const auto weight = weights_by_operator[op];
+                BLT_ASSERT(weight >= 0 && "Operator weights cannot be negative!");
+                total += weight;
+                if (weight != weights_by_operator[items.front()])
+                    uniform = false;
+            }
+            BLT_ASSERT(total > 0 && "At least one operator of every type must have a non-zero weight!");
+            if (uniform)
+                return;
+
+            const auto count = items.size();
+            probability.resize(count);
+            alias.resize(count);
+
+            thread_local tracked_vector<size_t> small;
+            thread_local tracked_vector<size_t> large;
+            small.clear();
+            large.clear();
+
+            for (size_t i = 0; i < count; i++)
+            {
+                probability[i] = weights_by_operator[items[i]] * static_cast<double>(count) / total;
+                alias[i] = i;
+                if (probability[i] < 1.0)
+                    small.push_back(i);
+                else
+                    large.push_back(i);
+            }
+
+            while (!small.empty() && !large.empty())
+            {
+                const auto s = small.back();
+                small.pop_back();
+                const auto l = large.back();
+                alias[s] = l;
+                probability[l] = (probability[l] + probability[s]) - 1.0;
+                if (probability[l] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+
+            // anything left over is only here because of floating point error
+            for (const auto i : small)
+                probability[i] = 1.0;
+            for (const auto i : large)
+                probability[i] = 1.0;
+        }
+
+        [[nodiscard]] operator_id select(random_t& random) const
+        {
+            const auto index = random.get_size_t(0ul, items.size());
+            if (uniform || random.get_double() < probability[index])
+                return items[index];
+            return items[alias[index]];
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return items.empty();
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return items.size();
+        }
+
+    private:
+        tracked_vector<operator_id> items;
+        tracked_vector<double> probability;
+        tracked_vector<size_t> alias;
+        bool uniform = true;
+    };
+}
+
+#endif //BLT_GP_UTIL_ALIAS_TABLE_H
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_UTIL_CALLABLE_H
+#define BLT_GP_UTIL_CALLABLE_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace blt::gp::detail
+{
+    template <typename Signature>
+    class callable_t;
+
+    /**
+     * Type erased callable made of a plain function pointer and a pointer to the data it is called with.
+     * Calling it is a single indirect call with no allocation or copy. The function pointer is usually a captureless lambda,
+     * which is free to inline whatever it calls on the data.
+     */
+    template <typename Return, typename... Args>
+    class callable_t<Return(Args...)>
+    {
+    public:
+        using func_t = Return (*)(const void*, Args...);
+
+        callable_t() = default;
+
+        /**
+         * @param func function to call, receives data as its first argument
+         * @param data pointer passed to func, which is not owned by the callable and must outlive it.
+         */
+        callable_t(const func_t func, const void* data = nullptr): m_func(func), m_data(data) // NOLINT
+        {
+        }
+
+        /**
+         * Creates a callable which owns a copy of func. The copy is shared between copies of the callable.
+         */
+        template <typename Func>
+        static callable_t make(Func&& func)
+        {
+            using func_type = std::decay_t<Func>;
+            auto storage = std::make_shared<const func_type>(std::forward<Func>(func));
+            callable_t callable{
+                [](const void* data, Args... args) -> Return {
+                    return (*static_cast<const func_type*>(data))(std::forward<Args>(args)...);
+                },
+                storage.get()
+            };
+            callable.m_storage = std::move(storage);
+            return callable;
+        }
+
+        Return operator()(Args... args) const
+        {
+            return m_func(m_data, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const
+        {
+            return m_func != nullptr;
+        }
+
+    private:
+        func_t m_func = nullptr;
+        const void* m_data = nullptr;
+        std::shared_ptr<const void> m_storage;
+    };
+}
+
+#endif //BLT_GP_UTIL_CALLABLE_H
@@ -0,0 +1,439 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLT_GP_UTIL_SMALL_VECTOR_H
+#define BLT_GP_UTIL_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace blt::gp
+{
+    namespace detail
+    {
+        /**
+         * Bytes stored inside of the object which inherits from this. Zero bytes gives an empty base which takes no space and whose data
+         * pointer is nullptr.
+         */
+        template <size_t Bytes, size_t Alignment>
+        struct inline_buffer_t
+        {
+            [[nodiscard]] unsigned char* inline_bytes() noexcept
+            {
+                return m_inline_bytes;
+            }
+
+            [[nodiscard]] const unsigned char* inline_bytes() const noexcept
+            {
+                return m_inline_bytes;
+            }
+
+            alignas(Alignment) unsigned char m_inline_bytes[Bytes];
+        };
+
+        template <size_t Alignment>
+        struct inline_buffer_t<0, Alignment>
+        {
+            [[nodiscard]] unsigned char* inline_bytes() noexcept
+            {
+                return nullptr;
+            }
+
+            [[nodiscard]] const unsigned char* inline_bytes() const noexcept
+            {
+                return nullptr;
+            }
+        };
+    }
+
+    /**
+     * Vector of trivially copyable elements which keeps up to InlineCount elements inside the object and only allocates from Allocator once it
+     * grows past that. Elements are moved around with memcpy, so iterators are plain pointers and are invalidated by moving the vector, even when
+     * it has not allocated. With an InlineCount of zero it behaves like a std::vector, starting out with a null data pointer.
+     *
+     * The allocator follows the vector on move and swap, and is reset with select_on_container_copy_construction() on copy.
+     */
+    template <typename T, size_t InlineCount, typename Allocator = std::allocator<T>>
+    class small_vector_t : detail::inline_buffer_t<InlineCount * sizeof(T), alignof(T)>
+    {
+        using buffer_t = detail::inline_buffer_t<InlineCount * sizeof(T), alignof(T)>;
+
+        static_assert(std::is_trivially_copyable_v<T>, "Elements of a small vector must be bitwise copyable!");
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        small_vector_t() = default;
+
+        explicit small_vector_t(const Allocator& allocator): m_allocator(allocator)
+        {
+        }
+
+        small_vector_t(const small_vector_t& copy):
+            m_allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(copy.m_allocator))
+        {
+            assign(copy);
+        }
+
+        small_vector_t(small_vector_t&& move) noexcept: m_allocator(std::move(move.m_allocator))
+        {
+            steal(move);
+        }
+
+        small_vector_t& operator=(const small_vector_t& copy)
+        {
+            if (this == &copy)
+                return *this;
+            assign(copy);
+            return *this;
+        }
+
+        small_vector_t& operator=(small_vector_t&& move) noexcept
+        {
+            if (this == &move)
+                return *this;
+            release();
+            m_allocator = std::move(move.m_allocator);
+            steal(move);
+            return *this;
+        }
+
+        ~small_vector_t()
+        {
+            release();
+        }
+
+        void swap(small_vector_t& other) noexcept
+        {
+            small_vector_t temp{std::move(other)};
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+        friend void swap(small_vector_t& a, small_vector_t& b) noexcept
+        {
+            a.swap(b);
+        }
+
+        [[nodiscard]] iterator begin() noexcept
+        {
+            return m_data;
+        }
+
+        [[nodiscard]] iterator end() noexcept
+        {
+            return m_data + m_size;
+        }
+
+        [[nodiscard]] const_iterator begin() const noexcept
+        {
+            return m_data;
+        }
+
+        [[nodiscard]] const_iterator end() const noexcept
+        {
+            return m_data + m_size;
+        }
+
+        [[nodiscard]] const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        [[nodiscard]] const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        [[nodiscard]] reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator{end()};
+        }
+
+        [[nodiscard]] reverse_iterator rend() noexcept
+        {
+            return reverse_iterator{begin()};
+        }
+
+        [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator{end()};
+        }
+
+        [[nodiscard]] const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator{begin()};
+        }
+
+        [[nodiscard]] T& operator[](const size_t index) noexcept
+        {
+            return m_data[index];
+        }
+
+        [[nodiscard]] const T& operator[](const size_t index) const noexcept
+        {
+            return m_data[index];
+        }
+
+        [[nodiscard]] T& front() noexcept
+        {
+            return m_data[0];
+        }
+
+        [[nodiscard]] const T& front() const noexcept
+        {
+            return m_data[0];
+        }
+
+        [[nodiscard]] T& back() noexcept
+        {
+            return m_data[m_size - 1];
+        }
+
+        [[nodiscard]] const T& back() const noexcept
+        {
+            return m_data[m_size - 1];
+        }
+
+        [[nodiscard]] T* data() noexcept
+        {
+            return m_data;
+        }
+
+        [[nodiscard]] const T* data() const noexcept
+        {
+            return m_data;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept
+        {
+            return m_capacity;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        /**
+         * @return true while the elements are stored inside the vector itself
+         */
+        [[nodiscard]] bool is_inline() const noexcept
+        {
+            return m_data == inline_data();
+        }
+
+        [[nodiscard]] allocator_type get_allocator() const
+        {
+            return m_allocator;
+        }
+
+        void reserve(const size_t count)
+        {
+            if (count > m_capacity)
+                reallocate(count);
+        }
+
+        void clear() noexcept
+        {
+            m_size = 0;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        template <typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            // constructed before growing, args may refer to an element of this vector
+            T value(std::forward<Args>(args)...);
+            if (m_size == m_capacity)
+                grow(m_size + 1);
+            std::memcpy(static_cast<void*>(m_data + m_size), &value, sizeof(T));
+            return m_data[m_size++];
+        }
+
+        void pop_back() noexcept
+        {
+            --m_size;
+        }
+
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
+        {
+            T value(std::forward<Args>(args)...);
+            const auto index = static_cast<size_t>(pos - m_data);
+            if (m_size == m_capacity)
+                grow(m_size + 1);
+            std::memmove(static_cast<void*>(m_data + index + 1), m_data + index, (m_size - index) * sizeof(T));
+            std::memcpy(static_cast<void*>(m_data + index), &value, sizeof(T));
+            ++m_size;
+            return m_data + index;
+        }
+
+        iterator insert(const_iterator pos, const T& value)
+        {
+            return emplace(pos, value);
+        }
+
+        // first and last must not point into this vector
+        template <typename Iter>
+        iterator insert(const_iterator pos, Iter first, Iter last)
+        {
+            const auto index = static_cast<size_t>(pos - m_data);
+            const auto count = static_cast<size_t>(std::distance(first, last));
+            if (count == 0)
+                return m_data + index;
+            if (m_size + count > m_capacity)
+            {
+                const auto old_data = m_data;
+                const auto old_capacity = m_capacity;
+                const auto new_capacity = std::max<size_t>(m_size + count, m_capacity + m_capacity / 2);
+                const auto new_data = std::allocator_traits<Allocator>::allocate(m_allocator, new_capacity);
+                // an empty vector without inline capacity has no data to copy from
+                if (old_data != nullptr)
+                {
+                    std::memcpy(static_cast<void*>(new_data), old_data, index * sizeof(T));
+                    std::memcpy(static_cast<void*>(new_data + index + count), old_data + index, (m_size - index) * sizeof(T));
+                }
+                std::copy(first, last, new_data + index);
+                m_data = new_data;
+                m_capacity = static_cast<std::uint32_t>(new_capacity);
+                m_size += static_cast<std::uint32_t>(count);
+                if (old_data != inline_data())
+                    std::allocator_traits<Allocator>::deallocate(m_allocator, old_data, old_capacity);
+                return m_data + index;
+            }
+            std::memmove(static_cast<void*>(m_data + index + count), m_data + index, (m_size - index) * sizeof(T));
+            std::copy(first, last, m_data + index);
+            m_size += static_cast<std::uint32_t>(count);
+            return m_data + index;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const auto index = static_cast<size_t>(first - m_data);
+            const auto count = static_cast<size_t>(last - first);
+            std::memmove(static_cast<void*>(m_data + index), m_data + index + count, (m_size - index - count) * sizeof(T));
+            m_size -= static_cast<std::uint32_t>(count);
+            return m_data + index;
+        }
+
+    private:
+        [[nodiscard]] T* inline_data() noexcept
+        {
+            return reinterpret_cast<T*>(buffer_t::inline_bytes());
+        }
+
+        [[nodiscard]] const T* inline_data() const noexcept
+        {
+            return reinterpret_cast<const T*>(buffer_t::inline_bytes());
+        }
+
+        void assign(const small_vector_t& copy)
+        {
+            if (copy.m_size > m_capacity)
+            {
+                const auto new_data = std::allocator_traits<Allocator>::allocate(m_allocator, copy.m_size);
+                release();
+                m_data = new_data;
+                m_capacity = copy.m_size;
+            }
+            if (copy.m_size > 0)
+                std::memcpy(static_cast<void*>(m_data), copy.m_data, copy.m_size * sizeof(T));
+            m_size = copy.m_size;
+        }
+
+        void grow(const size_t count)
+        {
+            reallocate(std::max<size_t>(count, m_capacity + m_capacity / 2));
+        }
+
+        void reallocate(const size_t capacity)
+        {
+            const auto new_data = std::allocator_traits<Allocator>::allocate(m_allocator, capacity);
+            if (m_size > 0)
+                std::memcpy(static_cast<void*>(new_data), m_data, m_size * sizeof(T));
+            release();
+            m_data = new_data;
+            m_capacity = static_cast<std::uint32_t>(capacity);
+        }
+
+        void release() noexcept
+        {
+            if (!is_inline())
+                std::allocator_traits<Allocator>::deallocate(m_allocator, m_data, m_capacity);
+        }
+
+        // takes the elements of move, whose allocator has already been taken, leaving it empty and inline
+        void steal(small_vector_t& move) noexcept
+        {
+            if (move.is_inline())
+            {
+                if constexpr (InlineCount > 0)
+                    std::memcpy(inline_data(), move.inline_data(), move.m_size * sizeof(T));
+                m_data = inline_data();
+                m_capacity = InlineCount;
+            } else
+            {
+                m_data = move.m_data;
+                m_capacity = move.m_capacity;
+                move.m_data = move.inline_data();
+                move.m_capacity = InlineCount;
+            }
+            m_size = move.m_size;
+            move.m_size = 0;
+        }
+
+        T* m_data = inline_data();
+        // 32 bit sizes keep the header of the vector at 16 bytes plus the allocator
+        std::uint32_t m_size = 0;
+        std::uint32_t m_capacity = InlineCount;
+        Allocator m_allocator;
+    };
+}
+
+#endif //BLT_GP_UTIL_SMALL_VECTOR_H
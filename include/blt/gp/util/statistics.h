@@ -165,7 +165,8 @@ namespace blt::gp
 
         population_stats(const population_stats& copy):
             overall_fitness(copy.overall_fitness.load()), average_fitness(copy.average_fitness.load()), best_fitness(copy.best_fitness.load()),
-            worst_fitness(copy.worst_fitness.load())
+            worst_fitness(copy.worst_fitness.load()), evaluation_time(copy.evaluation_time.load()),
+            evaluation_idle_time(copy.evaluation_idle_time.load())
         {
             normalized_fitness.reserve(copy.normalized_fitness.size());
             for (auto v : copy.normalized_fitness)
@@ -174,18 +175,25 @@ namespace blt::gp
 
         population_stats(population_stats&& move) noexcept:
             overall_fitness(move.overall_fitness.load()), average_fitness(move.average_fitness.load()), best_fitness(move.best_fitness.load()),
-            worst_fitness(move.worst_fitness.load()), normalized_fitness(std::move(move.normalized_fitness))
+            worst_fitness(move.worst_fitness.load()), evaluation_time(move.evaluation_time.load()),
+            evaluation_idle_time(move.evaluation_idle_time.load()), normalized_fitness(std::move(move.normalized_fitness))
         {
             move.overall_fitness = 0;
             move.average_fitness = 0;
             move.best_fitness = std::numeric_limits<double>::min();
             move.worst_fitness = std::numeric_limits<double>::max();
+            move.evaluation_time = 0;
+            move.evaluation_idle_time = 0;
         }
 
         std::atomic<double> overall_fitness = 0;
         std::atomic<double> average_fitness = 0;
         std::atomic<double> best_fitness = std::numeric_limits<double>::min();
         std::atomic<double> worst_fitness = std::numeric_limits<double>::max();
+        // wall time of the fitness evaluation in seconds, and the time threads spent waiting for the others to finish it summed over all
+        // threads. timings are not saved or compared
+        std::atomic<double> evaluation_time = 0;
+        std::atomic<double> evaluation_idle_time = 0;
         tracked_vector<double> normalized_fitness{};
 
         void clear()
@@ -194,6 +202,8 @@ namespace blt::gp
             average_fitness = 0;
             best_fitness = std::numeric_limits<double>::min();
             worst_fitness = std::numeric_limits<double>::max();
+            evaluation_time = 0;
+            evaluation_idle_time = 0;
             normalized_fitness.clear();
         }
 
@@ -0,0 +1,240 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/allocator.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace blt::gp
+{
+    namespace
+    {
+        constexpr size_t class_count()
+        {
+            size_t count = 1;
+            for (size_t size = slab_allocator_t::MIN_CLASS_SIZE; size < slab_allocator_t::MAX_CLASS_SIZE; size *= 2)
+                ++count;
+            return count;
+        }
+
+        constexpr size_t CLASS_COUNT = class_count();
+
+        // index of the smallest class holding total bytes, header included
+        size_t class_index(const size_t total)
+        {
+            size_t index = 0;
+            for (size_t size = slab_allocator_t::MIN_CLASS_SIZE; size < total; size *= 2)
+                ++index;
+            return index;
+        }
+
+        constexpr size_t class_size(const size_t index)
+        {
+            return slab_allocator_t::MIN_CLASS_SIZE << index;
+        }
+
+        struct free_block_t
+        {
+            free_block_t* next;
+        };
+
+        struct pool_t
+        {
+            // only touched by the thread owning the pool
+            free_block_t* local[CLASS_COUNT]{};
+            // blocks freed by other threads
+            std::atomic<free_block_t*> remote[CLASS_COUNT]{};
+            // single writer, the owning thread
+            std::atomic_uint64_t allocations = 0;
+            std::atomic_uint64_t system_allocations = 0;
+            // written by every thread returning blocks to this pool
+            std::atomic_uint64_t remote_frees = 0;
+        };
+
+        struct registry_t
+        {
+            std::mutex mutex;
+            std::vector<pool_t*> pools;
+            std::vector<pool_t*> released;
+        };
+
+        // never destroyed, blocks can still be freed during static destruction
+        registry_t& get_registry()
+        {
+            static auto* registry = new registry_t();
+            return *registry;
+        }
+
+        void increment(std::atomic_uint64_t& counter)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        enum class thread_state_t : u8
+        {
+            NONE, ACTIVE, EXITED
+        };
+
+        // plain thread locals so they stay valid while the thread locals freeing into the pool are destroyed
+        thread_local pool_t* thread_pool = nullptr;
+        thread_local thread_state_t thread_state = thread_state_t::NONE;
+
+        struct pool_releaser_t
+        {
+            ~pool_releaser_t()
+            {
+                auto& registry = get_registry();
+                std::scoped_lock lock(registry.mutex);
+                registry.released.push_back(thread_pool);
+                thread_pool = nullptr;
+                thread_state = thread_state_t::EXITED;
+            }
+        };
+
+        pool_t* get_thread_pool()
+        {
+            if (thread_pool != nullptr)
+                return thread_pool;
+            // anything allocated while the thread is exiting goes straight to the system allocator
+            if (thread_state == thread_state_t::EXITED)
+                return nullptr;
+            {
+                auto& registry = get_registry();
+                std::scoped_lock lock(registry.mutex);
+                if (!registry.released.empty())
+                {
+                    thread_pool = registry.released.back();
+                    registry.released.pop_back();
+                } else
+                {
+                    thread_pool = new pool_t();
+                    registry.pools.push_back(thread_pool);
+                }
+            }
+            thread_state = thread_state_t::ACTIVE;
+            thread_local pool_releaser_t releaser;
+            (void) releaser;
+            return thread_pool;
+        }
+
+        u8* system_allocate(const size_t bytes)
+        {
+            const auto ptr = static_cast<u8*>(std::aligned_alloc(detail::MAX_ALIGNMENT, detail::align_bytes(bytes)));
+            if (ptr == nullptr)
+                throw std::bad_alloc();
+            return ptr;
+        }
+
+        free_block_t* refill(pool_t& pool, const size_t index)
+        {
+            const auto block_size = class_size(index);
+            const auto slab_size = std::max(slab_allocator_t::SLAB_SIZE, block_size);
+            const auto slab = system_allocate(slab_size);
+            increment(pool.system_allocations);
+            free_block_t* head = nullptr;
+            // linked in address order, so consecutive allocations are next to each other
+            for (size_t offset = slab_size; offset >= block_size; offset -= block_size)
+            {
+                const auto block = reinterpret_cast<free_block_t*>(slab + offset - block_size);
+                block->next = head;
+                head = block;
+            }
+            return head;
+        }
+    }
+
+    void* slab_allocator_t::allocate(const size_t bytes)
+    {
+        const auto total = bytes + HEADER_SIZE;
+        pool_t* pool = get_thread_pool();
+        pool_t* owner = nullptr;
+        u8* block;
+        if (total > MAX_CLASS_SIZE || pool == nullptr)
+        {
+            block = system_allocate(total);
+            if (pool != nullptr)
+                increment(pool->system_allocations);
+        } else
+        {
+            const auto index = class_index(total);
+            auto head = pool->local[index];
+            if (head == nullptr)
+                head = pool->remote[index].exchange(nullptr, std::memory_order_acquire);
+            if (head == nullptr)
+                head = refill(*pool, index);
+            pool->local[index] = head->next;
+            block = reinterpret_cast<u8*>(head);
+            owner = pool;
+        }
+        if (pool != nullptr)
+            increment(pool->allocations);
+        std::memcpy(block, &owner, sizeof(owner));
+        return block + HEADER_SIZE;
+    }
+
+    void slab_allocator_t::deallocate(void* ptr, const size_t bytes)
+    {
+        if (ptr == nullptr)
+            return;
+        const auto block = static_cast<u8*>(ptr) - HEADER_SIZE;
+        pool_t* owner;
+        std::memcpy(&owner, block, sizeof(owner));
+        if (owner == nullptr)
+        {
+            std::free(block);
+            return;
+        }
+        const auto index = class_index(bytes + HEADER_SIZE);
+        const auto node = reinterpret_cast<free_block_t*>(block);
+        if (owner == thread_pool)
+        {
+            node->next = owner->local[index];
+            owner->local[index] = node;
+            return;
+        }
+        auto& head = owner->remote[index];
+        node->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        owner->remote_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t slab_allocator_t::usable_size(const size_t bytes)
+    {
+        const auto total = bytes + HEADER_SIZE;
+        if (total > MAX_CLASS_SIZE)
+            return detail::align_bytes(bytes);
+        return class_size(class_index(total)) - HEADER_SIZE;
+    }
+
+    slab_allocator_t::stats_t slab_allocator_t::get_stats()
+    {
+        stats_t stats;
+        auto& registry = get_registry();
+        std::scoped_lock lock(registry.mutex);
+        for (const auto* pool : registry.pools)
+        {
+            stats.allocations += pool->allocations.load(std::memory_order_relaxed);
+            stats.system_allocations += pool->system_allocations.load(std::memory_order_relaxed);
+            stats.remote_frees += pool->remote_frees.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+}
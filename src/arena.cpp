@@ -0,0 +1,117 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/arena.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace blt::gp
+{
+    namespace
+    {
+        // epochs are unique across all arenas, so a lease can never be mistaken for one on a new arena allocated at the same address
+        std::atomic_uint64_t next_epoch = 1;
+
+        struct lease_t
+        {
+            u64 epoch = 0;
+            u8* current = nullptr;
+            u8* end = nullptr;
+        };
+
+        // a thread only holds a lease on one arena at a time, which is the arena of the population being bred
+        thread_local lease_t thread_lease;
+    }
+
+    tree_arena_t::tree_arena_t(const size_t block_size, const size_t lease_size): epoch(next_epoch.fetch_add(1, std::memory_order_relaxed)),
+                                                                                  block_size(detail::align_bytes(block_size)),
+                                                                                  lease_size(detail::align_bytes(lease_size))
+    {
+    }
+
+    tree_arena_t::~tree_arena_t()
+    {
+        for (const auto& block : blocks)
+            aligned_allocator().deallocate(block.data, block.size);
+    }
+
+    void* tree_arena_t::allocate(size_t bytes)
+    {
+        bytes = detail::align_bytes(std::max(bytes, static_cast<size_t>(1)));
+        auto& lease = thread_lease;
+        if (lease.epoch != epoch || static_cast<size_t>(lease.end - lease.current) < bytes)
+        {
+            // large allocations are taken directly instead of throwing away the rest of the current lease
+            if (bytes > lease_size / 2)
+                return take(bytes);
+            lease.current = take(lease_size);
+            lease.end = lease.current + lease_size;
+            lease.epoch = epoch;
+        }
+        const auto ptr = lease.current;
+        lease.current += bytes;
+        return ptr;
+    }
+
+    void tree_arena_t::reset()
+    {
+        std::scoped_lock guard(lock);
+        epoch = next_epoch.fetch_add(1, std::memory_order_relaxed);
+        current_block = 0;
+        block_offset = 0;
+        used = 0;
+    }
+
+    size_t tree_arena_t::bytes_reserved() const
+    {
+        std::scoped_lock guard(lock);
+        size_t total = 0;
+        for (const auto& block : blocks)
+            total += block.size;
+        return total;
+    }
+
+    size_t tree_arena_t::bytes_used() const
+    {
+        std::scoped_lock guard(lock);
+        return used;
+    }
+
+    u8* tree_arena_t::take(const size_t bytes)
+    {
+        std::scoped_lock guard(lock);
+        used += bytes;
+        for (; current_block < blocks.size(); ++current_block, block_offset = 0)
+        {
+            const auto& block = blocks[current_block];
+            if (block.size - block_offset >= bytes)
+            {
+                const auto ptr = block.data + block_offset;
+                block_offset += bytes;
+                return ptr;
+            }
+        }
+        const auto size = std::max(bytes, block_size);
+        const auto data = static_cast<u8*>(aligned_allocator().allocate(size));
+        if (data == nullptr)
+            throw std::bad_alloc();
+        blocks.push_back({data, size});
+        block_offset = bytes;
+        return data;
+    }
+}
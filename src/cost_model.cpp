@@ -0,0 +1,73 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/cost_model.h>
+#include <algorithm>
+
+namespace blt::gp
+{
+    namespace
+    {
+        // weight of the newly measured costs against the previous ones
+        constexpr double LEARNING_RATE = 0.5;
+    }
+
+    void evaluation_cost_model_t::fit(const population_t& population, const tracked_vector<double>& estimates, const tracked_vector<double>& times)
+    {
+        const auto& individuals = population.get_individuals();
+        if (individuals.empty())
+            return;
+
+        share_sums.assign(operator_costs.size(), 0);
+        share_counts.assign(operator_costs.size(), 0);
+        double tree_share_sum = 0;
+        size_t tree_share_count = 0;
+
+        const auto stride = std::max<size_t>(1, individuals.size() / SAMPLES_PER_FIT);
+        for (size_t index = 0; index < individuals.size(); index += stride)
+        {
+            if (estimates[index] <= 0 || times[index] <= 0)
+                continue;
+            const auto& tree = individuals[index].tree;
+            // the measured time per unit of estimated cost
+            const auto scale = times[index] / estimates[index];
+
+            tree_share_sum += tree_cost * scale;
+            ++tree_share_count;
+            for (size_t i = 0; i < tree.size(); i++)
+            {
+                const auto id = static_cast<size_t>(tree.get_operator(i).id());
+                if (id >= operator_costs.size())
+                {
+                    operator_costs.resize(id + 1, 1);
+                    share_sums.resize(id + 1, 0);
+                    share_counts.resize(id + 1, 0);
+                }
+                share_sums[id] += operator_costs[id] * scale;
+                ++share_counts[id];
+            }
+        }
+
+        if (tree_share_count > 0)
+            tree_cost += (tree_share_sum / static_cast<double>(tree_share_count) - tree_cost) * LEARNING_RATE;
+        for (size_t id = 0; id < operator_costs.size(); id++)
+        {
+            if (share_counts[id] > 0)
+                operator_costs[id] += (share_sums[id] / static_cast<double>(share_counts[id]) - operator_costs[id]) * LEARNING_RATE;
+        }
+    }
+}
@@ -18,7 +18,9 @@
 #include <blt/gp/generators.h>
 #include <blt/gp/program.h>
 #include <blt/logging/logging.h>
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
 
 namespace blt::gp
 {
@@ -31,9 +33,11 @@ namespace blt::gp
         size_t depth;
     };
     
-    inline std::stack<stack> get_initial_stack(gp_program& program, type_id root_type)
+    inline tracked_vector<stack>& get_initial_stack(gp_program& program, type_id root_type)
     {
-        std::stack<stack> tree_generator;
+        // reused between calls so tree generation does not allocate once the buffer has grown large enough.
+        thread_local tracked_vector<stack> tree_generator;
+        tree_generator.clear();
 //
 //        auto& system = program.get_typesystem();
 //        // select a type which has a non-empty set of non-terminals
@@ -43,7 +47,7 @@ namespace blt::gp
 //            base_type = system.select_type(program.get_random());
 //        } while (program.get_type_non_terminals(base_type.id()).empty());
 //
-        tree_generator.push(stack{program.select_non_terminal(root_type), 1});
+        tree_generator.push_back(stack{program.select_non_terminal(root_type), 1});
         
         return tree_generator;
     }
@@ -51,141 +55,283 @@ namespace blt::gp
     template<typename Func>
     void create_tree(tree_t& tree, Func&& perChild, const generator_arguments& args)
     {
-        std::stack<stack> tree_generator = get_initial_stack(args.program, args.root_type);
+        auto& tree_generator = get_initial_stack(args.program, args.root_type);
+        const auto& table = args.program.get_operator_table();
         size_t max_depth = 0;
         
         while (!tree_generator.empty())
         {
-            auto top = tree_generator.top();
-            tree_generator.pop();
-            
-            auto& info = args.program.get_operator_info(top.id);
+            auto top = tree_generator.back();
+            tree_generator.pop_back();
 
-            tree.emplace_operator(
-                    args.program.get_typesystem().get_type(info.return_type).size(),
-                    top.id,
-                    args.program.is_operator_ephemeral(top.id),
-                    args.program.get_operator_flags(top.id));
+            const auto flags = table.flags[top.id];
+            tree.emplace_operator(table.return_sizes[top.id], top.id, flags.is_ephemeral(), flags);
             max_depth = std::max(max_depth, top.depth);
             
-            if (args.program.is_operator_ephemeral(top.id))
+            if (flags.is_ephemeral())
                 continue;
             
-            for (const auto& child : info.argument_types)
-                std::forward<Func>(perChild)(args.program, tree_generator, child, top.depth + 1);
+            for (auto child = table.arguments_begin(top.id); child != table.arguments_end(top.id); ++child)
+                std::forward<Func>(perChild)(args.program, tree_generator, *child, top.depth + 1);
         }
     }
     
     void grow_generator_t::generate(tree_t& tree, const generator_arguments& args)
     {
-        return create_tree(tree, [args](gp_program& program, std::stack<stack>& tree_generator, type_id type, blt::size_t new_depth) {
+        return create_tree(tree, [args](gp_program& program, tracked_vector<stack>& tree_generator, type_id type, blt::size_t new_depth) {
             if (new_depth >= args.max_depth)
             {
                 if (program.get_type_terminals(type).empty())
-                    tree_generator.push({program.select_non_terminal_too_deep(type), new_depth});
+                    tree_generator.push_back({program.select_non_terminal_too_deep(type), new_depth});
                 else
-                    tree_generator.push({program.select_terminal(type), new_depth});
+                    tree_generator.push_back({program.select_terminal(type), new_depth});
                 return;
             }
             if (program.get_random().choice() || new_depth < args.min_depth)
-                tree_generator.push({program.select_non_terminal(type), new_depth});
+                tree_generator.push_back({program.select_non_terminal(type), new_depth});
             else
-                tree_generator.push({program.select_terminal(type), new_depth});
+                tree_generator.push_back({program.select_terminal(type), new_depth});
         }, args);
     }
     
     void full_generator_t::generate(tree_t& tree, const generator_arguments& args)
     {
-        return create_tree(tree, [args](gp_program& program, std::stack<stack>& tree_generator, type_id type, blt::size_t new_depth) {
+        return create_tree(tree, [args](gp_program& program, tracked_vector<stack>& tree_generator, type_id type, blt::size_t new_depth) {
             if (new_depth >= args.max_depth)
             {
                 if (program.get_type_terminals(type).empty())
-                    tree_generator.push({program.select_non_terminal_too_deep(type), new_depth});
+                    tree_generator.push_back({program.select_non_terminal_too_deep(type), new_depth});
                 else
-                    tree_generator.push({program.select_terminal(type), new_depth});
+                    tree_generator.push_back({program.select_terminal(type), new_depth});
                 return;
             }
-            tree_generator.push({program.select_non_terminal(type), new_depth});
+            tree_generator.push_back({program.select_non_terminal(type), new_depth});
         }, args);
     }
     
-    population_t grow_initializer_t::generate(const initializer_arguments& args)
+    ptc2_generator_t::ptc2_generator_t(const size_t min_size, const size_t max_size): min_size(std::max(min_size, 1ul)),
+                                                                                          max_size(std::max(max_size, min_size))
     {
-        population_t pop;
+    }
+    
+    ptc2_generator_t::ptc2_generator_t(const std::vector<double>& size_weights): min_size(1), max_size(std::max(size_weights.size(), 1ul))
+    {
+        double total = 0;
+        for (const auto w : size_weights)
+            total += w;
+        BLT_ASSERT(total > 0 && "PTC2 size distribution must have a non-zero weight!");
+        double sum = 0;
+        for (const auto w : size_weights)
+        {
+            sum += w / total;
+            size_distribution.push_back(sum);
+        }
+    }
+    
+    size_t ptc2_generator_t::select_size(gp_program& program) const
+    {
+        if (size_distribution.empty())
+            return program.get_random().get_size_t(min_size, max_size + 1);
+        const auto choice = program.get_random().get_double();
+        const auto it = std::lower_bound(size_distribution.begin(), size_distribution.end(), choice);
+        if (it == size_distribution.end())
+            return size_distribution.size();
+        return static_cast<size_t>(it - size_distribution.begin()) + 1;
+    }
+    
+    void ptc2_generator_t::generate(tree_t& tree, const generator_arguments& args)
+    {
+        struct node_t
+        {
+            type_id type;
+            operator_id id;
+            size_t depth;
+            // children are always stored contiguously
+            size_t children_begin;
+        };
+        
+        thread_local tracked_vector<node_t> nodes;
+        thread_local tracked_vector<size_t> open_slots;
+        thread_local tracked_vector<size_t> emit_stack;
+        nodes.clear();
+        open_slots.clear();
+        emit_stack.clear();
+        
+        auto& program = args.program;
+        const auto& table = program.get_operator_table();
+        const auto target_size = select_size(program);
+        
+        const auto fill_slot = [&](const size_t index, const operator_id id) {
+            nodes[index].id = id;
+            nodes[index].children_begin = nodes.size();
+            if (table.flags[id].is_ephemeral())
+                return;
+            const auto depth = nodes[index].depth + 1;
+            for (auto child = table.arguments_begin(id); child != table.arguments_end(id); ++child)
+            {
+                open_slots.push_back(nodes.size());
+                nodes.push_back({*child, operator_id{0}, depth, 0});
+            }
+        };
         
-        for (auto i = 0ul; i < args.size; i++)
+        nodes.push_back({args.root_type, operator_id{0}, 1, 0});
+        if (target_size <= 1)
+            fill_slot(0, program.select_terminal(args.root_type));
+        else
+            fill_slot(0, program.select_non_terminal(args.root_type));
+        
+        // expand random slots until the number of filled nodes plus the open slots (which will become terminals) reaches the target
+        size_t filled = 1;
+        while (!open_slots.empty() && filled + open_slots.size() < target_size)
         {
-            tree_t tree{args.program};
-            grow.generate(tree, args.to_gen_args());
-            pop.get_individuals().emplace_back(tree);
+            const auto pick = program.get_random().get_size_t(0ul, open_slots.size());
+            const auto index = open_slots[pick];
+            open_slots[pick] = open_slots.back();
+            open_slots.pop_back();
+            
+            const auto type = nodes[index].type;
+            if (nodes[index].depth >= args.max_depth)
+                fill_slot(index, program.select_terminal(type));
+            else
+                fill_slot(index, program.select_non_terminal(type));
+            ++filled;
         }
         
-        return pop;
+        // operators chosen for types without terminals can add new slots here, which are also filled as terminals.
+        while (!open_slots.empty())
+        {
+            const auto index = open_slots.back();
+            open_slots.pop_back();
+            fill_slot(index, program.select_terminal(nodes[index].type));
+        }
+        
+        // emit in the same order as the depth based generators, the last argument directly follows its parent.
+        emit_stack.push_back(0);
+        while (!emit_stack.empty())
+        {
+            const auto& node = nodes[emit_stack.back()];
+            emit_stack.pop_back();
+            
+            const auto flags = table.flags[node.id];
+            tree.emplace_operator(table.return_sizes[node.id], node.id, flags.is_ephemeral(), flags);
+            
+            if (flags.is_ephemeral())
+                continue;
+            
+            for (size_t i = 0; i < table.argc[node.id]; i++)
+                emit_stack.push_back(node.children_begin + i);
+        }
     }
     
-    population_t full_initializer_t::generate(const initializer_arguments& args)
+    struct structural_hash_t
+    {
+        size_t operator()(const tree_t* tree) const
+        {
+            return tree->structural_hash();
+        }
+    };
+    
+    struct structural_equals_t
+    {
+        bool operator()(const tree_t* a, const tree_t* b) const
+        {
+            return *a == *b;
+        }
+    };
+    
+    population_t population_initializer_t::generate_population(const initializer_arguments& args,
+                                                               const std::function<void(tree_t&, size_t)>& generate_tree) const
     {
+        // trees are cheap to generate, so hand them out in larger chunks than the fitness evaluation does.
+        constexpr size_t chunk_size = 64;
+        
         population_t pop;
+        auto& individuals = pop.get_individuals();
+        individuals.reserve(args.size);
+        for (size_t i = 0; i < args.size; i++)
+            individuals.emplace_back(tree_t{args.program});
         
-        for (auto i = 0ul; i < args.size; i++)
+        std::atomic_uint64_t next_index = 0;
+        args.program.execute_on_threads([&](size_t) {
+            while (true)
+            {
+                const size_t begin = next_index.fetch_add(chunk_size, std::memory_order_relaxed);
+                if (begin >= args.size)
+                    break;
+                const size_t end = std::min(begin + chunk_size, args.size);
+                for (size_t i = begin; i < end; i++)
+                    generate_tree(individuals[i].tree, i);
+            }
+        });
+        
+        if (!remove_duplicates)
+            return pop;
+        
+        std::unordered_set<const tree_t*, structural_hash_t, structural_equals_t> seen;
+        seen.reserve(args.size);
+        for (size_t i = 0; i < args.size; i++)
         {
-            tree_t tree{args.program};
-            full.generate(tree, args.to_gen_args());
-            pop.get_individuals().emplace_back(tree);
+            auto& tree = individuals[i].tree;
+            for (size_t attempt = 0; attempt < max_duplicate_retries && seen.find(&tree) != seen.end(); attempt++)
+            {
+                tree.clear(args.program);
+                generate_tree(tree, i);
+            }
+            seen.insert(&tree);
         }
         
         return pop;
     }
     
+    population_t grow_initializer_t::generate(const initializer_arguments& args)
+    {
+        return generate_population(args, [this, &args](tree_t& tree, size_t) {
+            grow.generate(tree, args.to_gen_args());
+        });
+    }
+    
+    population_t full_initializer_t::generate(const initializer_arguments& args)
+    {
+        return generate_population(args, [this, &args](tree_t& tree, size_t) {
+            full.generate(tree, args.to_gen_args());
+        });
+    }
+    
     population_t half_half_initializer_t::generate(const initializer_arguments& args)
     {
-        population_t pop;
-        
-        for (auto i = 0ul; i < args.size; i++)
-        {
-            tree_t tree{args.program};
+        return generate_population(args, [this, &args](tree_t& tree, size_t) {
             if (args.program.get_random().choice())
                 full.generate(tree, args.to_gen_args());
             else
                 grow.generate(tree, args.to_gen_args());
-            pop.get_individuals().emplace_back(tree);
-        }
-        
-        return pop;
+        });
+    }
+    
+    population_t ptc2_initializer_t::generate(const initializer_arguments& args)
+    {
+        return generate_population(args, [this, &args](tree_t& tree, size_t) {
+            ptc2.generate(tree, args.to_gen_args());
+        });
     }
     
     population_t ramped_half_initializer_t::generate(const initializer_arguments& args)
     {
         auto steps = args.max_depth - args.min_depth;
         auto per_step = args.size / steps;
-        auto remainder = args.size % steps;
-        population_t pop;
         
-        for (auto depth : blt::range(args.min_depth, args.max_depth))
-        {
-            for (auto i = 0ul; i < per_step; i++)
-            {
-                tree_t tree{args.program};
-                if (args.program.get_random().choice())
-                    full.generate(tree, {args.program, args.root_type, args.min_depth, depth});
-                else
-                    grow.generate(tree, {args.program, args.root_type, args.min_depth, depth});
-                pop.get_individuals().emplace_back(tree);
-            }
-        }
-        
-        for (auto i = 0ul; i < remainder; i++)
-        {
-            tree_t tree{args.program};
+        auto pop = generate_population(args, [this, &args, steps, per_step](tree_t& tree, const size_t index) {
+            // the first per_step * steps trees are ramped from min_depth up to max_depth, the remainder use the full depth range.
+            generator_arguments gen_args = args.to_gen_args();
+            if (index < per_step * steps)
+                gen_args.max_depth = args.min_depth + index / per_step;
             if (args.program.get_random().choice())
-                full.generate(tree, args.to_gen_args());
+                full.generate(tree, gen_args);
             else
-                grow.generate(tree, args.to_gen_args());
-            pop.get_individuals().emplace_back(tree);
-        }
+                grow.generate(tree, gen_args);
+        });
         
         BLT_ASSERT(pop.get_individuals().size() == args.size);
         
         return pop;
     }
-}
\ No newline at end of file
+}
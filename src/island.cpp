@@ -0,0 +1,258 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/island.h>
+#include <blt/gp/program.h>
+#include <blt/std/assert.h>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+namespace blt::gp
+{
+    island_model_t::migration_queue_t::migration_queue_t(gp_program& destination, const size_t capacity)
+    {
+        m_slots.reserve(capacity);
+        for (size_t i = 0; i < capacity; i++)
+            m_slots.emplace_back(destination);
+    }
+
+    island_model_t::island_model_t(std::vector<gp_program*> islands, const config_t& config): m_islands(std::move(islands)), m_config(config)
+    {
+        BLT_ASSERT_MSG(!m_islands.empty(), "Island model requires at least one island!");
+        BLT_ASSERT_MSG(m_config.migration_interval == 0 || (m_config.migrants > 0 && m_config.queued_migrations > 0),
+                       "Migration requires at least one migrant and room for one migration in the queues!");
+        m_immigrants = std::make_unique<std::atomic_size_t[]>(m_islands.size());
+        m_dropped = std::make_unique<std::atomic_size_t[]>(m_islands.size());
+        build_topology();
+    }
+
+    void island_model_t::run(const std::function<void(size_t island, gp_program& program)>& on_generation)
+    {
+        const auto evolve = [this, &on_generation](const size_t island) {
+            auto& program = *m_islands[island];
+            while (!program.should_terminate())
+            {
+                program.create_next_generation();
+                program.next_generation();
+                program.evaluate_fitness();
+                if (m_config.migration_interval != 0 && program.get_current_generation() % m_config.migration_interval == 0)
+                    migrate(island);
+                if (on_generation)
+                    on_generation(island, program);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(m_islands.size() - 1);
+        for (size_t i = 1; i < m_islands.size(); i++)
+            threads.emplace_back(evolve, i);
+        evolve(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void island_model_t::migrate(const size_t island)
+    {
+        emigrate(island);
+        immigrate(island);
+    }
+
+    size_t island_model_t::get_best_island() const
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < m_islands.size(); i++)
+        {
+            if (m_islands[i]->get_population_stats().best_fitness > m_islands[best]->get_population_stats().best_fitness)
+                best = i;
+        }
+        return best;
+    }
+
+    void island_model_t::build_topology()
+    {
+        const auto count = m_islands.size();
+        m_neighbours.resize(count);
+        for (size_t i = 0; i < count && count > 1; i++)
+        {
+            auto& neighbours = m_neighbours[i];
+            switch (m_config.topology)
+            {
+                case topology_t::RING:
+                    neighbours.push_back((i + 1) % count);
+                    break;
+                case topology_t::TORUS:
+                {
+                    auto width = m_config.torus_width;
+                    if (width == 0)
+                    {
+                        width = 1;
+                        for (size_t w = 1; w * w <= count; w++)
+                        {
+                            if (count % w == 0)
+                                width = w;
+                        }
+                    }
+                    BLT_ASSERT_MSG(count % width == 0, "Torus width must divide the number of islands!");
+                    const auto height = count / width;
+                    const auto row = i / width;
+                    const auto column = i % width;
+                    for (const auto neighbour : {row * width + (column + 1) % width, row * width + (column + width - 1) % width,
+                                                 (row + 1) % height * width + column, (row + height - 1) % height * width + column})
+                    {
+                        // narrow grids wrap onto the same neighbour, or the island itself
+                        if (neighbour != i && std::find(neighbours.begin(), neighbours.end(), neighbour) == neighbours.end())
+                            neighbours.push_back(neighbour);
+                    }
+                    break;
+                }
+                case topology_t::FULLY_CONNECTED:
+                    for (size_t j = 0; j < count; j++)
+                    {
+                        if (j != i)
+                            neighbours.push_back(j);
+                    }
+                    break;
+            }
+        }
+
+        m_incoming.resize(count);
+        m_outgoing.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (const auto neighbour : m_neighbours[i])
+            {
+                m_incoming[neighbour].push_back(
+                    std::make_unique<migration_queue_t>(*m_islands[neighbour], m_config.migrants * m_config.queued_migrations));
+                m_outgoing[i].push_back(m_incoming[neighbour].back().get());
+            }
+        }
+    }
+
+    void island_model_t::emigrate(const size_t island)
+    {
+        thread_local tracked_vector<size_t> emigrants;
+        auto& program = *m_islands[island];
+        const auto& pop = program.get_current_pop();
+        const auto& adjusted_fitness = pop.get_adjusted_fitness();
+        const auto size = pop.get_individuals().size();
+        const auto count = std::min(m_config.migrants, size);
+
+        emigrants.clear();
+        switch (m_config.emigrant_policy)
+        {
+            case emigrant_policy_t::BEST:
+            {
+                const auto& ranking = pop.get_ranking();
+                if (ranking.size() >= count)
+                {
+                    emigrants.insert(emigrants.end(), ranking.begin(), ranking.begin() + static_cast<ptrdiff_t>(count));
+                    break;
+                }
+                // only the best few individuals are ranked unless a selection needs the whole population in order
+                emigrants.resize(size);
+                std::iota(emigrants.begin(), emigrants.end(), 0);
+                std::partial_sort(emigrants.begin(), emigrants.begin() + static_cast<ptrdiff_t>(count), emigrants.end(),
+                                  [&adjusted_fitness](const size_t a, const size_t b) {
+                                      return adjusted_fitness[a] > adjusted_fitness[b] || (adjusted_fitness[a] == adjusted_fitness[b] && a < b);
+                                  });
+                emigrants.resize(count);
+                break;
+            }
+            case emigrant_policy_t::RANDOM:
+                for (size_t i = 0; i < count; i++)
+                    emigrants.push_back(program.get_random().get_size_t(0ul, size));
+                break;
+        }
+
+        for (size_t i = 0; i < m_outgoing[island].size(); i++)
+        {
+            auto& queue = *m_outgoing[island][i];
+            for (const auto index : emigrants)
+            {
+                auto* migrant = queue.back();
+                if (migrant == nullptr)
+                {
+                    m_dropped[m_neighbours[island][i]].fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                migrant->tree.copy_fast(pop.get_individuals()[index].tree);
+                migrant->fitness = pop.get_fitness(index);
+                queue.push();
+            }
+        }
+    }
+
+    void island_model_t::immigrate(const size_t island)
+    {
+        thread_local tracked_vector<size_t> victims;
+        auto& program = *m_islands[island];
+        const auto& pop = program.get_current_pop();
+        const auto& adjusted_fitness = pop.get_adjusted_fitness();
+        const auto size = pop.get_individuals().size();
+        // the elites stay in place under either replacement policy
+        const auto elites = std::min(program.get_config().elites, size);
+
+        size_t arrived = 0;
+        for (const auto& queue : m_incoming[island])
+            arrived += queue->size();
+        arrived = std::min(arrived, size - elites);
+        if (arrived == 0)
+            return;
+
+        victims.clear();
+        switch (m_config.replacement_policy)
+        {
+            case replacement_policy_t::WORST:
+                victims.resize(size);
+                std::iota(victims.begin(), victims.end(), 0);
+                std::partial_sort(victims.begin(), victims.begin() + static_cast<ptrdiff_t>(arrived), victims.end(),
+                                  [&adjusted_fitness](const size_t a, const size_t b) {
+                                      return adjusted_fitness[a] < adjusted_fitness[b] || (adjusted_fitness[a] == adjusted_fitness[b] && a > b);
+                                  });
+                victims.resize(arrived);
+                break;
+            case replacement_policy_t::RANDOM:
+            {
+                const auto& ranking = pop.get_ranking();
+                const auto elites_end = ranking.begin() + static_cast<ptrdiff_t>(std::min(elites, ranking.size()));
+                while (victims.size() < arrived)
+                {
+                    const auto victim = program.get_random().get_size_t(0ul, size);
+                    if (std::find(ranking.begin(), elites_end, victim) == elites_end &&
+                        std::find(victims.begin(), victims.end(), victim) == victims.end())
+                        victims.push_back(victim);
+                }
+                break;
+            }
+        }
+
+        // only the receiver pops, so at least arrived migrants are waiting in the queues
+        size_t queue = 0;
+        program.replace_individuals(victims, [this, island, &queue](size_t, tree_t& tree, fitness_t& fitness) {
+            auto& incoming = m_incoming[island];
+            auto* migrant = incoming[queue]->front();
+            while (migrant == nullptr)
+                migrant = incoming[++queue]->front();
+            tree.copy_fast(migrant->tree);
+            fitness = migrant->fitness;
+            incoming[queue]->pop();
+        });
+        m_immigrants[island].fetch_add(victims.size(), std::memory_order_relaxed);
+    }
+}
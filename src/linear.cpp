@@ -0,0 +1,440 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/linear.h>
+#include <blt/gp/program.h>
+#include <algorithm>
+#include <cstring>
+
+namespace blt::gp
+{
+    linear_crossover_t default_linear_crossover;
+    linear_mutation_t default_linear_mutation;
+
+    linear_layout_t::linear_layout_t(gp_program& program, const type_id output_type, const size_t registers_per_type):
+        output_type(output_type), registers_per_type(registers_per_type)
+    {
+        BLT_ASSERT(registers_per_type > 0 && registers_per_type <= std::numeric_limits<u16>::max() && "Invalid number of registers per type!");
+        auto& system = program.get_typesystem();
+        bank_offsets.resize(system.size());
+        register_sizes.resize(system.size());
+        for (size_t i = 0; i < system.size(); i++)
+        {
+            const type_id id{i};
+            const auto type = system.get_type(id);
+            if (type.has_ephemeral_drop())
+                BLT_ABORT(("Type " + std::string(type.name()) + " has a drop function, which linear programs do not support!").c_str());
+            bank_offsets[i] = total_bytes;
+            register_sizes[i] = type.size();
+            total_bytes += type.size() * registers_per_type;
+            if (!program.get_type_terminals(id).empty() || !program.get_type_non_terminals(id).empty())
+                usable_types.push_back(id);
+        }
+        BLT_ASSERT(!program.get_type_terminals(output_type).empty() || !program.get_type_non_terminals(output_type).empty());
+    }
+
+    linear_program_t::instruction_t linear_program_t::random_instruction(const double terminal_chance) const
+    {
+        auto& random = m_program->get_random();
+        // results of the output type are always useful, so bias destinations towards it
+        type_id type = m_layout->output_type;
+        if (!random.choice())
+            type = random.select(m_layout->usable_types);
+
+        instruction_t instruction{};
+        instruction.id = random.choice(terminal_chance) ? m_program->select_terminal(type) : m_program->select_non_terminal(type);
+
+        const auto& info = m_program->get_operator_info(instruction.id);
+        BLT_ASSERT(info.argument_types.size() <= max_arguments && "Operator has too many arguments to be used in a linear program!");
+        instruction.argc = static_cast<u16>(info.argument_types.size());
+        randomize_registers(instruction);
+
+        if (m_program->is_operator_ephemeral(instruction.id))
+        {
+            const auto size = m_program->get_typesystem().get_type(info.return_type).size();
+            BLT_ASSERT(size <= max_constant_bytes && "Ephemeral type is too large to be stored in a linear program!");
+            thread_local stack_allocator constant_stack;
+            info.func(nullptr, constant_stack, constant_stack);
+            constant_stack.copy_to(instruction.constant.data(), size);
+            constant_stack.pop_bytes(size);
+        }
+        return instruction;
+    }
+
+    void linear_program_t::randomize_registers(instruction_t& instruction) const
+    {
+        auto& random = m_program->get_random();
+        instruction.destination = static_cast<u16>(random.get_size_t(0ul, m_layout->registers_per_type));
+        for (size_t i = 0; i < instruction.argc; i++)
+            instruction.arguments[i] = static_cast<u16>(random.get_size_t(0ul, m_layout->registers_per_type));
+    }
+
+    void linear_program_t::generate(const size_t length)
+    {
+        instructions.clear();
+        for (size_t i = 0; i < length; i++)
+            instructions.push_back(random_instruction());
+        update_effective();
+    }
+
+    void linear_program_t::update_effective()
+    {
+        // registers which are read by an instruction after the current one (or are the output)
+        thread_local tracked_vector<u8> needed;
+        const auto total_registers = m_layout->bank_offsets.size() * m_layout->registers_per_type;
+        needed.clear();
+        needed.resize(total_registers, false);
+        const auto register_index = [this](const type_id type, const size_t index) {
+            return static_cast<size_t>(type) * m_layout->registers_per_type + index;
+        };
+        needed[register_index(m_layout->output_type, 0)] = true;
+
+        effective.clear();
+        for (auto i = static_cast<ptrdiff_t>(instructions.size()) - 1; i >= 0; i--)
+        {
+            const auto& instruction = instructions[i];
+            const auto& info = m_program->get_operator_info(instruction.id);
+            const auto dest = register_index(info.return_type, instruction.destination);
+            if (!needed[dest])
+                continue;
+            needed[dest] = false;
+            for (size_t a = 0; a < instruction.argc; a++)
+                needed[register_index(info.argument_types[a], instruction.arguments[a])] = true;
+            effective.push_back(static_cast<u32>(i));
+        }
+        std::reverse(effective.begin(), effective.end());
+    }
+
+    const u8* linear_program_t::execute(void* context) const
+    {
+        thread_local tracked_vector<u8> registers;
+        thread_local stack_allocator stack;
+        registers.clear();
+        registers.resize(m_layout->total_bytes, 0);
+        stack.reset();
+
+        for (const auto index : effective)
+        {
+            const auto& instruction = instructions[index];
+            const auto& info = m_program->get_operator_info(instruction.id);
+            const auto return_size = m_layout->register_sizes[info.return_type];
+            auto* dest = registers.data() + m_layout->register_offset(info.return_type, instruction.destination);
+            if (m_program->is_operator_ephemeral(instruction.id))
+            {
+                std::memcpy(dest, instruction.constant.data(), return_size);
+                continue;
+            }
+            for (size_t a = 0; a < instruction.argc; a++)
+            {
+                const auto type = info.argument_types[a];
+                stack.copy_from(registers.data() + m_layout->register_offset(type, instruction.arguments[a]), m_layout->register_sizes[type]);
+            }
+            info.func(context, stack, stack);
+            stack.copy_to(dest, return_size);
+            stack.pop_bytes(return_size);
+        }
+
+        return registers.data();
+    }
+
+    void linear_program_t::print(std::ostream& out, const bool only_effective) const
+    {
+        auto& system = m_program->get_typesystem();
+        const auto print_instruction = [&](const instruction_t& instruction) {
+            const auto& info = m_program->get_operator_info(instruction.id);
+            out << system.get_type(info.return_type).name() << instruction.destination << " = "
+                << m_program->get_name(instruction.id).value_or("[Unnamed Operator]");
+            if (m_program->is_operator_ephemeral(instruction.id))
+            {
+                thread_local stack_allocator print_stack;
+                print_stack.reset();
+                print_stack.copy_from(instruction.constant.data(), m_layout->register_sizes[info.return_type]);
+                out << ' ';
+                m_program->get_print_func(instruction.id)(out, print_stack);
+            } else if (instruction.argc > 0)
+            {
+                out << '(';
+                for (size_t a = 0; a < instruction.argc; a++)
+                {
+                    if (a != 0)
+                        out << ", ";
+                    out << system.get_type(info.argument_types[a]).name() << instruction.arguments[a];
+                }
+                out << ')';
+            }
+            out << '\n';
+        };
+        if (only_effective)
+        {
+            for (const auto index : effective)
+                print_instruction(instructions[index]);
+        } else
+        {
+            for (const auto& instruction : instructions)
+                print_instruction(instruction);
+        }
+    }
+
+    bool linear_crossover_t::apply(gp_program& program, const linear_program_t& p1, const linear_program_t& p2, linear_program_t& c1,
+                                   linear_program_t& c2)
+    {
+        auto& random = program.get_random();
+        const auto& i1 = p1.get_instructions();
+        const auto& i2 = p2.get_instructions();
+        if (i1.empty() || i2.empty())
+            return false;
+
+        const auto length1 = random.get_size_t(1ul, std::min(config.max_segment_length, i1.size()) + 1);
+        const auto length2 = random.get_size_t(1ul, std::min(config.max_segment_length, i2.size()) + 1);
+        const auto new_size1 = i1.size() - length1 + length2;
+        const auto new_size2 = i2.size() - length2 + length1;
+        if (new_size1 < config.min_program_length || new_size1 > config.max_program_length ||
+            new_size2 < config.min_program_length || new_size2 > config.max_program_length)
+            return false;
+
+        const auto start1 = static_cast<ptrdiff_t>(random.get_size_t(0ul, i1.size() - length1 + 1));
+        const auto start2 = static_cast<ptrdiff_t>(random.get_size_t(0ul, i2.size() - length2 + 1));
+        const auto end1 = start1 + static_cast<ptrdiff_t>(length1);
+        const auto end2 = start2 + static_cast<ptrdiff_t>(length2);
+
+        auto& o1 = c1.get_instructions();
+        auto& o2 = c2.get_instructions();
+        o1.clear();
+        o1.insert(o1.end(), i1.begin(), i1.begin() + start1);
+        o1.insert(o1.end(), i2.begin() + start2, i2.begin() + end2);
+        o1.insert(o1.end(), i1.begin() + end1, i1.end());
+
+        o2.clear();
+        o2.insert(o2.end(), i2.begin(), i2.begin() + start2);
+        o2.insert(o2.end(), i1.begin() + start1, i1.begin() + end1);
+        o2.insert(o2.end(), i2.begin() + end2, i2.end());
+
+        c1.update_effective();
+        c2.update_effective();
+        return true;
+    }
+
+    bool linear_mutation_t::apply(gp_program& program, const linear_program_t&, linear_program_t& c)
+    {
+        auto& random = program.get_random();
+        auto& instructions = c.get_instructions();
+
+        if (instructions.empty() || random.choice(config.macro_mutation_chance))
+        {
+            const bool can_insert = instructions.size() < config.max_program_length;
+            const bool can_delete = instructions.size() > config.min_program_length;
+            if (can_insert && (!can_delete || random.choice()))
+            {
+                const auto point = static_cast<ptrdiff_t>(random.get_size_t(0ul, instructions.size() + 1));
+                instructions.insert(instructions.begin() + point, c.random_instruction(config.terminal_chance));
+            } else if (can_delete)
+            {
+                const auto point = static_cast<ptrdiff_t>(random.get_size_t(0ul, instructions.size()));
+                instructions.erase(instructions.begin() + point);
+            } else
+                return false;
+            c.update_effective();
+            return true;
+        }
+
+        // modifying instructions which do not contribute to the output will not change the program's behaviour
+        const auto& effective = c.get_effective();
+        const size_t index = effective.empty() ? random.get_size_t(0ul, instructions.size()) : effective[random.get_size_t(0ul, effective.size())];
+        auto& instruction = instructions[index];
+        const auto& info = program.get_operator_info(instruction.id);
+
+        switch (random.get_size_t(0ul, 3ul))
+        {
+            case 0:
+                // new register for a single argument, or the destination if there are no arguments
+                if (instruction.argc > 0)
+                {
+                    instruction.arguments[random.get_size_t(0ul, instruction.argc)] =
+                        static_cast<u16>(random.get_size_t(0ul, c.get_layout().registers_per_type));
+                    break;
+                }
+                [[fallthrough]];
+            case 1:
+                instruction.destination = static_cast<u16>(random.get_size_t(0ul, c.get_layout().registers_per_type));
+                break;
+            default:
+                {
+                    // replace the operation, keeping the destination so the data flow is mostly preserved
+                    const auto destination = instruction.destination;
+                    auto replacement = c.random_instruction(config.terminal_chance);
+                    if (program.get_operator_info(replacement.id).return_type == info.return_type)
+                        replacement.destination = destination;
+                    instruction = replacement;
+                }
+                break;
+        }
+        c.update_effective();
+        return true;
+    }
+
+    linear_gp_t::config_t::config_t(): crossover(default_linear_crossover), mutator(default_linear_mutation)
+    {
+    }
+
+    void linear_gp_t::generate_initial_population(const type_id output_type)
+    {
+        layout = linear_layout_t{program, output_type, config.registers_per_type};
+        const auto population_size = program.get_config().population_size;
+
+        current_generation = 0;
+        current_pop.clear();
+        next_pop.clear();
+        current_pop.reserve(population_size);
+        next_pop.reserve(population_size);
+        for (size_t i = 0; i < population_size; i++)
+        {
+            current_pop.push_back({linear_program_t{program, layout}, {}});
+            next_pop.push_back({linear_program_t{program, layout}, {}});
+        }
+
+        std::atomic_uint64_t next_index = 0;
+        execute_chunked([this](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++)
+                current_pop[i].program.generate(program.get_random().get_size_t(config.initial_min_length, config.initial_max_length + 1));
+        }, next_index);
+    }
+
+    void linear_gp_t::execute_chunked(const std::function<void(size_t, size_t)>& func, std::atomic_uint64_t& next_index) const
+    {
+        const auto size = current_pop.size();
+        const auto chunk_size = std::max(program.get_config().evaluation_size, 1ul);
+        program.execute_on_threads([&](size_t) {
+            while (true)
+            {
+                const size_t begin = next_index.fetch_add(chunk_size, std::memory_order_relaxed);
+                if (begin >= size)
+                    break;
+                func(begin, std::min(begin + chunk_size, size));
+            }
+        });
+    }
+
+    void linear_gp_t::update_stats()
+    {
+        double best = std::numeric_limits<double>::lowest();
+        double worst = std::numeric_limits<double>::max();
+        double sum_of_prob = 0;
+        for (const auto& ind : current_pop)
+        {
+            best = std::max(best, ind.fitness.adjusted_fitness);
+            worst = std::min(worst, ind.fitness.adjusted_fitness);
+            const auto prob = ind.fitness.adjusted_fitness / current_stats.overall_fitness;
+            current_stats.normalized_fitness.push_back(sum_of_prob + prob);
+            sum_of_prob += prob;
+        }
+        current_stats.best_fitness = best;
+        current_stats.worst_fitness = worst;
+        current_stats.average_fitness = current_stats.overall_fitness / static_cast<double>(current_pop.size());
+    }
+
+    const linear_program_t& linear_gp_t::select() const
+    {
+        auto& random = program.get_random();
+        size_t best = random.get_size_t(0ul, current_pop.size());
+        for (size_t i = 1; i < config.tournament_size; i++)
+        {
+            const auto other = random.get_size_t(0ul, current_pop.size());
+            if (current_pop[other].fitness.adjusted_fitness > current_pop[best].fitness.adjusted_fitness)
+                best = other;
+        }
+        return current_pop[best].program;
+    }
+
+    void linear_gp_t::create_next_generation()
+    {
+        const auto& prog_config = program.get_config();
+        const auto total = prog_config.crossover_chance + prog_config.mutation_chance + prog_config.reproduction_chance;
+        const auto crossover_chance = prog_config.crossover_chance / total;
+        const auto mutation_chance = prog_config.mutation_chance / total;
+
+        size_t elites = std::min(prog_config.elites, current_pop.size());
+        if (elites > 0)
+        {
+            thread_local tracked_vector<size_t> indexes;
+            indexes.resize(current_pop.size());
+            for (size_t i = 0; i < indexes.size(); i++)
+                indexes[i] = i;
+            std::partial_sort(indexes.begin(), indexes.begin() + static_cast<ptrdiff_t>(elites), indexes.end(), [this](size_t a, size_t b) {
+                return current_pop[a].fitness.adjusted_fitness > current_pop[b].fitness.adjusted_fitness;
+            });
+            for (size_t i = 0; i < elites; i++)
+                next_pop[i].program = current_pop[indexes[i]].program;
+        }
+
+        const auto max_crossover_iterations = prog_config.crossover.get().get_config().max_crossover_iterations;
+        std::atomic_uint64_t next_index = elites;
+        execute_chunked([&](const size_t begin, const size_t end) {
+            auto& random = program.get_random();
+            thread_local linear_program_t scratch{program, layout};
+            for (size_t i = begin; i < end;)
+            {
+                auto& c1 = next_pop[i].program;
+                const auto choice = random.get_double();
+                if (choice < crossover_chance)
+                {
+                    // crossover fills two children, at the end of a chunk the second one is built in scratch space and discarded
+                    const bool has_second = i + 1 < end;
+                    auto& c2 = has_second ? next_pop[i + 1].program : scratch;
+                    size_t tries = 0;
+                    bool success;
+                    do
+                    {
+                        const auto& p1 = select();
+                        const auto& p2 = select();
+                        // copying a parent binds the scratch space to this program and layout
+                        if (!has_second)
+                            scratch = p2;
+                        success = config.crossover.get().apply(program, p1, p2, c1, c2);
+                        if (!success)
+                        {
+                            c1 = p1;
+                            c2 = p2;
+                        }
+                    } while (!success && ++tries < max_crossover_iterations);
+                    i += has_second ? 2 : 1;
+                } else if (choice < crossover_chance + mutation_chance)
+                {
+                    const auto& p = select();
+                    c1 = p;
+                    config.mutator.get().apply(program, p, c1);
+                    i++;
+                } else
+                {
+                    c1 = select();
+                    i++;
+                }
+            }
+        }, next_index);
+    }
+
+    bool linear_gp_t::should_terminate() const
+    {
+        return current_generation >= program.get_config().max_generations || fitness_should_exit;
+    }
+
+    const linear_individual_t& linear_gp_t::get_best_individual() const
+    {
+        return *std::max_element(current_pop.begin(), current_pop.end(), [](const auto& a, const auto& b) {
+            return a.fitness.adjusted_fitness < b.fitness.adjusted_fitness;
+        });
+    }
+}
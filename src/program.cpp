@@ -56,10 +56,36 @@ namespace blt::gp
 
     random_t& gp_program::get_random() const
     {
-        thread_local static blt::gp::random_t random_engine{seed_func()};
+        // each thread offsets the seed, otherwise every thread would produce the exact same sequence when given a fixed seed.
+        // the first thread to ask for an engine (usually the main thread) gets the seed unmodified.
+        static std::atomic_uint64_t thread_count = 0;
+        thread_local static blt::gp::random_t random_engine{seed_func() + thread_count.fetch_add(1) * 0x9E3779B97F4A7C15ul};
         return random_engine;
     }
 
+    void gp_program::execute_on_threads(const std::function<void(size_t)>& func)
+    {
+        {
+            std::unique_lock lock(thread_helper.thread_function_control);
+            if (thread_execution_service != nullptr || thread_helper.threads.empty())
+            {
+                lock.unlock();
+                func(0);
+                return;
+            }
+            thread_helper.task = &func;
+            thread_helper.tasks_complete = 0;
+            ++thread_helper.task_epoch;
+        }
+        thread_helper.thread_function_condition.notify_all();
+        func(0);
+        std::unique_lock lock(thread_helper.thread_function_control);
+        thread_helper.thread_function_condition.wait(lock, [this]() {
+            return thread_helper.tasks_complete == thread_helper.threads.size() || should_thread_terminate();
+        });
+        thread_helper.task = nullptr;
+    }
+
     stack_allocator::Allocator& stack_allocator::get_allocator()
     {
         static Allocator allocator;
@@ -70,9 +96,10 @@ namespace blt::gp
     {
         const auto individuals = current_pop.get_individuals().size();
         writer.write(&individuals, sizeof(individuals));
-        for (const auto& individual : current_pop.get_individuals())
+        for (const auto& [i, individual] : enumerate(current_pop.get_individuals()))
         {
-            writer.write(&individual.fitness, sizeof(individual.fitness));
+            const fitness_t fitness = current_pop.get_fitness(i);
+            writer.write(&fitness, sizeof(fitness));
             individual.tree.to_file(writer);
         }
     }
@@ -86,12 +113,19 @@ namespace blt::gp
             for (size_t i = current_pop.get_individuals().size(); i < individuals; i++)
                 current_pop.get_individuals().emplace_back(tree_t{*this});
         }
-        for (auto& individual : current_pop.get_individuals())
+        current_pop.reset_fitness();
+        for (size_t i = 0; i < current_pop.get_individuals().size(); i++)
         {
-            BLT_ASSERT_RET(reader.read(&individual.fitness, sizeof(individual.fitness)) == sizeof(individual.fitness));
-            individual.tree.clear(*this);
-            individual.tree.from_file(reader);
+            fitness_t fitness;
+            BLT_ASSERT_RET(reader.read(&fitness, sizeof(fitness)) == sizeof(fitness));
+            current_pop.set_fitness(i, fitness);
+            auto& tree = current_pop.get_individuals()[i].tree;
+            tree.clear(*this);
+            tree.from_file(reader);
         }
+        current_pop.rank_by_fitness(ranking_size());
+        if (async_steady_state)
+            prepare_async_population();
         return true;
     }
 
@@ -249,6 +283,7 @@ namespace blt::gp
                 tracker.await_thread_loading_complete(config.threads);
 #endif
                 std::function<void(blt::size_t)>* execution_function = nullptr;
+                size_t last_task_epoch = 0;
                 while (!should_thread_terminate())
                 {
                     if (execution_function == nullptr)
@@ -256,6 +291,17 @@ namespace blt::gp
                         std::unique_lock lock(thread_helper.thread_function_control);
                         while (thread_execution_service == nullptr)
                         {
+                            if (thread_helper.task_epoch != last_task_epoch)
+                            {
+                                last_task_epoch = thread_helper.task_epoch;
+                                const auto* task = thread_helper.task;
+                                lock.unlock();
+                                (*task)(i);
+                                lock.lock();
+                                ++thread_helper.tasks_complete;
+                                thread_helper.thread_function_condition.notify_all();
+                                continue;
+                            }
                             thread_helper.thread_function_condition.wait(lock);
                             if (should_thread_terminate())
                                 return;
@@ -20,34 +20,29 @@
 
 namespace blt::gp
 {
-    void select_best_t::pre_process(gp_program&, population_t&)
+    void select_best_t::pre_process(gp_program&, population_t& pop)
     {
-        // std::sort(pop.begin(), pop.end(), [](const auto& a, const auto& b)
-        // {
-        //     return a.fitness.adjusted_fitness > b.fitness.adjusted_fitness;
-        // });
+        BLT_ASSERT_MSG(pop.get_ranking().size() == pop.get_individuals().size(), "Population has not been fully ranked!");
         index = 0;
     }
 
     const tree_t& select_best_t::select(gp_program&, const population_t& pop)
     {
-        const auto size = pop.get_individuals().size();
-        return pop.get_individuals()[index.fetch_add(1, std::memory_order_relaxed) % size].tree;
+        const auto& ranking = pop.get_ranking();
+        return pop.get_individuals()[ranking[index.fetch_add(1, std::memory_order_relaxed) % ranking.size()]].tree;
     }
 
-    void select_worst_t::pre_process(gp_program&, population_t&)
+    void select_worst_t::pre_process(gp_program&, population_t& pop)
     {
-        // std::sort(pop.begin(), pop.end(), [](const auto& a, const auto& b)
-        // {
-        //     return a.fitness.adjusted_fitness < b.fitness.adjusted_fitness;
-        // });
+        BLT_ASSERT_MSG(pop.get_ranking().size() == pop.get_individuals().size(), "Population has not been fully ranked!");
         index = 0;
     }
 
     const tree_t& select_worst_t::select(gp_program&, const population_t& pop)
     {
-        const auto size = pop.get_individuals().size();
-        return pop.get_individuals()[(size - 1) - (index.fetch_add(1, std::memory_order_relaxed) % size)].tree;
+        const auto& ranking = pop.get_ranking();
+        const auto size = ranking.size();
+        return pop.get_individuals()[ranking[(size - 1) - (index.fetch_add(1, std::memory_order_relaxed) % size)]].tree;
     }
 
     const tree_t& select_random_t::select(gp_program& program, const population_t& pop)
@@ -59,7 +54,7 @@ namespace blt::gp
     {
         thread_local hashset_t<u64> already_selected;
         already_selected.clear();
-        auto& i_ref = pop.get_individuals();
+        const auto& adjusted_fitness = pop.get_adjusted_fitness();
 
         u64 best = program.get_random().get_u64(0, pop.get_individuals().size());
         for (size_t i = 0; i < std::min(selection_size, pop.get_individuals().size()); i++)
@@ -71,27 +66,27 @@ namespace blt::gp
             }
             while (already_selected.contains(sel_point));
             already_selected.insert(sel_point);
-            if (i_ref[sel_point].fitness.adjusted_fitness > i_ref[best].fitness.adjusted_fitness)
+            if (adjusted_fitness[sel_point] > adjusted_fitness[best])
                 best = sel_point;
         }
-        return i_ref[best].tree;
+        return pop.get_individuals()[best].tree;
     }
 
     const tree_t& select_fitness_proportionate_t::select(gp_program& program, const population_t& pop)
     {
         auto& stats = program.get_population_stats();
         auto choice = program.get_random().get_double();
-        for (const auto& [index, ref] : blt::enumerate(pop))
+        for (size_t index = 0; index < pop.get_individuals().size(); index++)
         {
             if (index == 0)
             {
                 if (choice <= stats.normalized_fitness[index])
-                    return ref.tree;
+                    return pop.get_individuals()[index].tree;
             }
             else
             {
                 if (choice > stats.normalized_fitness[index - 1] && choice <= stats.normalized_fitness[index])
-                    return ref.tree;
+                    return pop.get_individuals()[index].tree;
             }
         }
         BLT_WARN("Unable to find individual_t with fitness proportionate. This should not be a possible code path! (%lf)", choice);
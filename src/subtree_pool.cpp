@@ -0,0 +1,137 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/subtree_pool.h>
+#include <blt/gp/program.h>
+#include <algorithm>
+
+namespace blt::gp
+{
+    grow_generator_t pool_grow_generator;
+
+    subtree_pool_t::config_t::config_t(): generator(pool_grow_generator)
+    {
+    }
+
+    tree_t* subtree_pool_t::acquire(gp_program& program, const type_id type, const size_t min_depth, const size_t max_depth)
+    {
+        if (static_cast<size_t>(type) < buckets_by_type.size())
+        {
+            for (auto* bucket : buckets_by_type[type])
+            {
+                if (bucket->depth.min_depth != min_depth || bucket->depth.max_depth != max_depth)
+                    continue;
+                const auto size = bucket->trees.size();
+                if (size == 0)
+                    break;
+                const auto draw = bucket->draws.fetch_add(1, std::memory_order_relaxed);
+                tree_t* tree = nullptr;
+                switch (config.reuse_policy)
+                {
+                    case reuse_policy_t::CONSUME:
+                        if (draw < size)
+                            tree = &bucket->trees[draw];
+                        break;
+                    case reuse_policy_t::CYCLE:
+                        if (draw < size * config.max_uses)
+                            tree = &bucket->trees[draw % size];
+                        break;
+                    case reuse_policy_t::RANDOM:
+                        tree = &bucket->trees[program.get_random().get_size_t(0ul, size)];
+                        break;
+                }
+                if (tree == nullptr)
+                    break;
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return tree;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    void subtree_pool_t::begin_refill(gp_program& program)
+    {
+        if (owner == nullptr)
+            owner = &program;
+        BLT_ASSERT_MSG(owner == &program, "Subtree pool is already used by another program!");
+        refill_cursor = 0;
+        if (config.trees_per_bucket == 0)
+            return;
+        auto& system = program.get_typesystem();
+        if (buckets_by_type.size() == system.size())
+            return;
+        buckets_by_type.resize(system.size());
+        for (size_t i = 0; i < system.size(); i++)
+        {
+            const type_id type{i};
+            // types with no operators can never be generated.
+            if (program.get_type_terminals(type).empty() && program.get_type_non_terminals(type).empty())
+                continue;
+            if (!buckets_by_type[i].empty())
+                continue;
+            for (const auto& range : config.depth_ranges)
+            {
+                buckets.push_back(std::make_unique<bucket_t>(type, range));
+                buckets_by_type[i].push_back(buckets.back().get());
+            }
+        }
+    }
+
+    void subtree_pool_t::refill(gp_program& program)
+    {
+        while (true)
+        {
+            const auto index = refill_cursor.fetch_add(1, std::memory_order_relaxed);
+            if (index >= buckets.size())
+                return;
+            refill_bucket(program, *buckets[index]);
+        }
+    }
+
+    void subtree_pool_t::refill_bucket(gp_program& program, bucket_t& bucket)
+    {
+        const generator_arguments args{program, bucket.type, bucket.depth.min_depth, bucket.depth.max_depth};
+        // only the trees which were handed out need to be regenerated. every policy hands trees out starting from the front of the bucket
+        // except for random, for which the choice of which trees get replaced does not matter.
+        const auto used = std::min(static_cast<size_t>(bucket.draws.load(std::memory_order_relaxed)), bucket.trees.size());
+        for (size_t i = 0; i < used; i++)
+        {
+            bucket.trees[i].clear(program);
+            config.generator.get().generate(bucket.trees[i], args);
+        }
+        size_t generated = used;
+        while (bucket.trees.size() < config.trees_per_bucket)
+        {
+            auto& tree = bucket.trees.emplace_back(program);
+            config.generator.get().generate(tree, args);
+            ++generated;
+        }
+        bucket.draws.store(0, std::memory_order_relaxed);
+        trees_generated.fetch_add(generated, std::memory_order_relaxed);
+    }
+
+    void subtree_pool_t::clear(const gp_program& program)
+    {
+        if (owner != &program)
+            return;
+        owner = nullptr;
+        buckets_by_type.clear();
+        buckets.clear();
+        refill_cursor = 0;
+    }
+}
@@ -0,0 +1,355 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <blt/gp/threading.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace blt::gp
+{
+    namespace
+    {
+        // the spin limit of a thread starts at the minimum, doubles whenever a wait ends while spinning and halves whenever it does not
+        constexpr u32 MIN_SPIN = 64;
+        constexpr u32 MAX_SPIN = 1 << 16;
+        constexpr u32 YIELDS = 16;
+        // spins on a slot lock before yielding, the thread holding it may have been descheduled
+        constexpr u32 SLOT_SPINS = 64;
+
+        void cpu_relax()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+    }
+
+    work_stealing_scheduler_t::work_stealing_scheduler_t(const size_t thread_count): thread_count(std::max<size_t>(thread_count, 1)),
+                                                                                     parts(new part_t[this->thread_count])
+    {
+    }
+
+    void work_stealing_scheduler_t::reset(const size_t count, size_t active_threads)
+    {
+        BLT_ASSERT_MSG(count <= 0xFFFFFFFFul, "Work stealing scheduler only supports 32 bit ranges!");
+        active_threads = std::clamp<size_t>(active_threads, 1, thread_count);
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            const auto begin = i < active_threads ? count * i / active_threads : count;
+            const auto end = i < active_threads ? count * (i + 1) / active_threads : count;
+            parts[i].range.store(pack(begin, end), std::memory_order_relaxed);
+        }
+        steals.store(0, std::memory_order_relaxed);
+    }
+
+    void work_stealing_scheduler_t::reset(const size_t count, const double* costs, size_t active_threads)
+    {
+        BLT_ASSERT_MSG(count <= 0xFFFFFFFFul, "Work stealing scheduler only supports 32 bit ranges!");
+        active_threads = std::clamp<size_t>(active_threads, 1, thread_count);
+        double total = 0;
+        for (size_t i = 0; i < count; i++)
+            total += costs[i];
+
+        size_t begin = 0;
+        double cost = 0;
+        for (size_t part = 0; part < thread_count; part++)
+        {
+            auto end = begin;
+            if (part + 1 >= active_threads)
+                end = count;
+            else
+            {
+                // the part ends once the running total reaches its share of the total cost
+                const auto target = total * static_cast<double>(part + 1) / static_cast<double>(active_threads);
+                while (end < count && cost + costs[end] <= target)
+                    cost += costs[end++];
+            }
+            parts[part].range.store(pack(begin, end), std::memory_order_relaxed);
+            begin = end;
+        }
+        steals.store(0, std::memory_order_relaxed);
+    }
+
+    bool work_stealing_scheduler_t::next(const size_t thread_index, const size_t chunk_size, size_t& begin, size_t& end)
+    {
+        auto& part = parts[thread_index].range;
+        auto range = part.load(std::memory_order_relaxed);
+        while (begin_of(range) < end_of(range))
+        {
+            begin = begin_of(range);
+            end = std::min(end_of(range), begin + std::max<size_t>(chunk_size, 1));
+            if (part.compare_exchange_weak(range, pack(end, end_of(range)), std::memory_order_relaxed, std::memory_order_relaxed))
+                return true;
+        }
+        return steal(thread_index, chunk_size, begin, end);
+    }
+
+    bool work_stealing_scheduler_t::steal(const size_t thread_index, size_t chunk_size, size_t& begin, size_t& end)
+    {
+        chunk_size = std::max<size_t>(chunk_size, 1);
+        while (true)
+        {
+            // the largest part is the least likely to run out while we are stealing from it
+            size_t victim = thread_count;
+            size_t largest = 0;
+            for (size_t i = 0; i < thread_count; i++)
+            {
+                const auto range = parts[i].range.load(std::memory_order_relaxed);
+                const auto remaining = end_of(range) - std::min(begin_of(range), end_of(range));
+                if (i != thread_index && remaining > largest)
+                {
+                    victim = i;
+                    largest = remaining;
+                }
+            }
+            if (victim == thread_count)
+                return false;
+
+            auto& part = parts[victim].range;
+            auto range = part.load(std::memory_order_relaxed);
+            while (begin_of(range) < end_of(range))
+            {
+                const auto remaining = end_of(range) - begin_of(range);
+                // small parts are taken whole, otherwise the owner keeps the front half
+                const auto taken = remaining <= chunk_size ? remaining : (remaining + 1) / 2;
+                const auto stolen_begin = end_of(range) - taken;
+                if (!part.compare_exchange_weak(range, pack(begin_of(range), stolen_begin), std::memory_order_relaxed,
+                                                std::memory_order_relaxed))
+                    continue;
+                steals.fetch_add(1, std::memory_order_relaxed);
+                begin = stolen_begin;
+                end = std::min(stolen_begin + taken, begin + chunk_size);
+                // nobody steals from an empty part, so the rest can be published to our own without contention
+                parts[thread_index].range.store(pack(end, stolen_begin + taken), std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    adaptive_barrier_t::adaptive_barrier_t(const size_t thread_count, const std::optional<std::reference_wrapper<std::atomic_bool>> exit_cond):
+        thread_count(std::max<size_t>(thread_count, 1)), exit_cond(exit_cond), waiters(new waiter_t[this->thread_count])
+    {
+        // spinning only helps if every thread has a core to itself, otherwise it takes time away from the threads being waited on
+        max_spin = std::thread::hardware_concurrency() >= this->thread_count ? MAX_SPIN : 0;
+        for (size_t i = 0; i < this->thread_count; i++)
+            waiters[i].spin_limit = std::min(MIN_SPIN, max_spin);
+    }
+
+    adaptive_barrier_t::phase_t adaptive_barrier_t::arrive()
+    {
+        // every thread of this phase arrives before it completes, so they all read the same phase
+        const auto current = phase.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == thread_count)
+        {
+            // nobody can arrive for the next phase until it has begun
+            arrived.store(0, std::memory_order_relaxed);
+            phase.store(current + 1, std::memory_order_seq_cst);
+            if (parked.load(std::memory_order_seq_cst) > 0)
+                wake();
+        }
+        return current;
+    }
+
+    void adaptive_barrier_t::wait(const size_t thread_index, const phase_t phase)
+    {
+        BLT_ASSERT_MSG(thread_index < thread_count, "Thread index is outside of the barrier!");
+        auto& waiter = waiters[thread_index];
+        if (released(phase))
+            return;
+        const auto start = std::chrono::steady_clock::now();
+
+        bool spun = false;
+        for (u32 i = 0; i < waiter.spin_limit; i++)
+        {
+            if (released(phase))
+            {
+                spun = true;
+                break;
+            }
+            cpu_relax();
+        }
+        if (spun)
+            waiter.spin_limit = std::min(waiter.spin_limit * 2, max_spin);
+        else
+        {
+            waiter.spin_limit = std::max(std::min(MIN_SPIN, max_spin), waiter.spin_limit / 2);
+            for (u32 i = 0; i < YIELDS && !released(phase); i++)
+                std::this_thread::yield();
+            if (!released(phase))
+            {
+                waiter.parks.store(waiter.parks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                park(phase);
+            }
+        }
+
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        waiter.wait_ns.store(waiter.wait_ns.load(std::memory_order_relaxed) + static_cast<u64>(waited), std::memory_order_relaxed);
+    }
+
+    void adaptive_barrier_t::notify_all()
+    {
+        phase.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+    }
+
+    double adaptive_barrier_t::get_wait_time(const size_t thread_index) const
+    {
+        return static_cast<double>(waiters[thread_index].wait_ns.load(std::memory_order_relaxed)) / 1e9;
+    }
+
+    double adaptive_barrier_t::get_total_wait_time() const
+    {
+        double total = 0;
+        for (size_t i = 0; i < thread_count; i++)
+            total += get_wait_time(i);
+        return total;
+    }
+
+    size_t adaptive_barrier_t::get_parks(const size_t thread_index) const
+    {
+        return waiters[thread_index].parks.load(std::memory_order_relaxed);
+    }
+
+    void adaptive_barrier_t::reset_wait_times()
+    {
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            waiters[i].wait_ns.store(0, std::memory_order_relaxed);
+            waiters[i].parks.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool adaptive_barrier_t::released(const phase_t phase) const
+    {
+        return this->phase.load(std::memory_order_acquire) != phase || (exit_cond && exit_cond->get().load(std::memory_order_relaxed));
+    }
+
+    void adaptive_barrier_t::park(const phase_t phase)
+    {
+        // either the thread completing the phase sees us as parked, or we see the new phase before sleeping
+        parked.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+        static_assert(sizeof(std::atomic<phase_t>) == sizeof(phase_t), "Futex requires a lock free 32 bit phase!");
+        while (!released(phase))
+            syscall(SYS_futex, reinterpret_cast<phase_t*>(&this->phase), FUTEX_WAIT_PRIVATE, phase, nullptr, nullptr, 0);
+#else
+        {
+            std::unique_lock lock(park_mutex);
+            park_condition.wait(lock, [&] { return released(phase); });
+        }
+#endif
+        parked.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void adaptive_barrier_t::wake()
+    {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<phase_t*>(&phase), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        // taking the lock orders the wake after a parking thread's last check of the phase
+        {
+            std::scoped_lock lock(park_mutex);
+        }
+        park_condition.notify_all();
+#endif
+    }
+
+    void claim_bitmap_t::reset(const size_t count)
+    {
+        const auto needed = (count + 63) / 64;
+        if (needed != word_count)
+        {
+            words.reset(new std::atomic_uint64_t[needed]);
+            word_count = needed;
+        }
+        this->count = count;
+        for (size_t i = 0; i < word_count; i++)
+            words[i].store(0, std::memory_order_relaxed);
+    }
+
+    void concurrent_slots_t::reset(const size_t count)
+    {
+        if (count != this->count)
+        {
+            slots.reset(new slot_t[count]);
+            this->count = count;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            slots[i].state.store(0, std::memory_order_relaxed);
+            slots[i].fitness.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void concurrent_slots_t::lock_shared(const size_t slot)
+    {
+        auto& state = slots[slot].state;
+        auto current = state.load(std::memory_order_relaxed);
+        u32 spins = 0;
+        while (true)
+        {
+            if (current & WRITER)
+            {
+                if (++spins % SLOT_SPINS == 0)
+                    std::this_thread::yield();
+                else
+                    cpu_relax();
+                current = state.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    bool concurrent_slots_t::try_claim(const size_t slot)
+    {
+        auto& state = slots[slot].state;
+        auto current = state.load(std::memory_order_relaxed);
+        while (!(current & CLAIMED))
+        {
+            if (state.compare_exchange_weak(current, current | CLAIMED, std::memory_order_relaxed, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    void concurrent_slots_t::lock_claimed(const size_t slot)
+    {
+        auto& state = slots[slot].state;
+        BLT_ASSERT_MSG(state.load(std::memory_order_relaxed) & CLAIMED, "Slot must be claimed before it is locked!");
+        auto current = CLAIMED;
+        u32 spins = 0;
+        // readers only hold the slot while copying from it, and nobody else can take the writer bit of a claimed slot
+        while (!state.compare_exchange_weak(current, CLAIMED | WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            current = CLAIMED;
+            if (++spins % SLOT_SPINS == 0)
+                std::this_thread::yield();
+            else
+                cpu_relax();
+        }
+    }
+}
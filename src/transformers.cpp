@@ -17,6 +17,7 @@
  */
 #include <blt/gp/transformers.h>
 #include <blt/gp/program.h>
+#include <blt/gp/subtree_pool.h>
 #include <blt/std/ranges.h>
 #include <blt/std/utility.h>
 #include <algorithm>
@@ -413,14 +414,26 @@ namespace blt::gp
         return true;
     }
 
+    tree_t& mutation_t::get_replacement_tree(gp_program& program, const type_id type) const
+    {
+        if (config.subtree_pool != nullptr)
+        {
+            if (auto* pooled = config.subtree_pool->acquire(program, type, config.replacement_min_depth, config.replacement_max_depth))
+                return *pooled;
+        }
+        auto& tree = tree_t::get_thread_local(program);
+        config.generator.get().generate(tree, {program, type, config.replacement_min_depth, config.replacement_max_depth});
+        return tree;
+    }
+
     size_t mutation_t::mutate_point(gp_program& program, tree_t& c, const tree_t::subtree_point_t node) const
     {
-        auto& new_tree = tree_t::get_thread_local(program);
 #if BLT_DEBUG_LEVEL >= 2
-        auto previous_size = new_tree.size();
-        auto previous_bytes = new_tree.total_value_bytes();
+        auto& previous_tree = tree_t::get_thread_local(program);
+        auto previous_size = previous_tree.size();
+        auto previous_bytes = previous_tree.total_value_bytes();
 #endif
-        config.generator.get().generate(new_tree, {program, node.type, config.replacement_min_depth, config.replacement_max_depth});
+        auto& new_tree = get_replacement_tree(program, node.type);
 
 #if BLT_DEBUG_LEVEL >= 2
         const auto old_op = c.get_operator(node.pos);
@@ -491,8 +504,7 @@ namespace blt::gp
                     if (!node.is_value())
                     {
                         auto& current_func_info = program.get_operator_info(node.id());
-                        operator_id random_replacement = program.get_random().select(
-                            program.get_type_non_terminals(current_func_info.return_type.id));
+                        operator_id random_replacement = program.select_non_terminal(current_func_info.return_type);
                         auto& replacement_func_info = program.get_operator_info(random_replacement);
 
                         // cache memory used for offset data.
@@ -507,9 +519,7 @@ namespace blt::gp
                             if (index < current_func_info.argument_types.size() && val.id != current_func_info.argument_types[index].id)
                             {
                                 // TODO: new config?
-                                auto& tree = tree_t::get_thread_local(program);
-                                config.generator.get().generate(tree,
-                                                                {program, val.id, config.replacement_min_depth, config.replacement_max_depth});
+                                auto& tree = get_replacement_tree(program, val.id);
 
                                 auto& [child_start, child_end] = children_data[children_data.size() - 1 - index];
                                 c.replace_subtree(c.subtree_from_point(child_start), child_end, tree);
@@ -555,12 +565,7 @@ namespace blt::gp
                             for (ptrdiff_t i = static_cast<ptrdiff_t>(replacement_func_info.argc.argc) - 1;
                                  i >= current_func_info.argc.argc; i--)
                             {
-                                auto& tree = tree_t::get_thread_local(program);
-                                config.generator.get().generate(tree,
-                                                                {
-                                                                    program, replacement_func_info.argument_types[i].id, config.replacement_min_depth,
-                                                                    config.replacement_max_depth
-                                                                });
+                                auto& tree = get_replacement_tree(program, replacement_func_info.argument_types[i].id);
                                 start_index = c.insert_subtree(tree_t::subtree_point_t(static_cast<ptrdiff_t>(start_index)), tree);
                             }
                         }
@@ -597,7 +602,7 @@ namespace blt::gp
                     auto& non_terminals = program.get_type_non_terminals(current_func_info.return_type.id);
                     if (non_terminals.empty())
                         continue;
-                    operator_id random_replacement = program.get_random().select(non_terminals);
+                    operator_id random_replacement = program.select_non_terminal(current_func_info.return_type);
                     size_t arg_position = 0;
                     do
                     {
@@ -610,7 +615,7 @@ namespace blt::gp
                                 goto exit;
                             }
                         }
-                        random_replacement = program.get_random().select(program.get_type_non_terminals(current_func_info.return_type.id));
+                        random_replacement = program.select_non_terminal(current_func_info.return_type);
                     }
                     while (true);
                 exit:
@@ -630,34 +635,19 @@ namespace blt::gp
                     size_t start_index = c_node;
                     for (ptrdiff_t i = new_argc - 1; i > static_cast<ptrdiff_t>(arg_position); i--)
                     {
-                        auto& tree = tree_t::get_thread_local(program);
-                        config.generator.get().generate(tree,
-                                                        {
-                                                            program, replacement_func_info.argument_types[i].id, config.replacement_min_depth,
-                                                            config.replacement_max_depth
-                                                        });
+                        auto& tree = get_replacement_tree(program, replacement_func_info.argument_types[i].id);
                         start_index = c.insert_subtree(tree_t::subtree_point_t(static_cast<ptrdiff_t>(start_index)), tree);
                     }
                     start_index += size;
                     // vals.copy_from(combined_ptr, for_bytes);
                     for (blt::ptrdiff_t i = static_cast<blt::ptrdiff_t>(arg_position) - 1; i >= 0; i--)
                     {
-                        auto& tree = tree_t::get_thread_local(program);
-                        config.generator.get().generate(tree,
-                                                        {
-                                                            program, replacement_func_info.argument_types[i].id, config.replacement_min_depth,
-                                                            config.replacement_max_depth
-                                                        });
+                        auto& tree = get_replacement_tree(program, replacement_func_info.argument_types[i].id);
                         start_index = c.insert_subtree(tree_t::subtree_point_t(static_cast<ptrdiff_t>(start_index)), tree);
                     }
                     // vals.copy_from(combined_ptr + for_bytes, after_bytes);
 
-                    c.insert_operator(c_node, {
-                                          program.get_typesystem().get_type(replacement_func_info.return_type).size(),
-                                          random_replacement,
-                                          program.is_operator_ephemeral(random_replacement),
-                                          program.get_operator_flags(random_replacement)
-                                      });
+                    c.insert_operator(c_node, program.get_operator_container(random_replacement));
 #if BLT_DEBUG_LEVEL >= 2
                     if (!c.check(detail::debug::context_ptr))
                     {
@@ -20,6 +20,8 @@
 #include <blt/std/assert.h>
 #include <blt/logging/logging.h>
 #include <blt/gp/program.h>
+#include <algorithm>
+#include <numeric>
 #include <stack>
 
 namespace blt::gp
@@ -56,6 +58,7 @@ namespace blt::gp
 
     void tree_t::byte_only_transaction_t::move(const size_t bytes_to_move)
     {
+        tree.detach();
         bytes = bytes_to_move;
         data = get_thread_pointer_for_size<struct move_tempoary_bytes>(bytes);
         tree.values.copy_to(data, bytes);
@@ -65,6 +68,8 @@ namespace blt::gp
     void tree_t::print(std::ostream& out, const bool print_literals, const bool pretty_print, const bool include_types,
                        const ptrdiff_t marked_index) const
     {
+        if (m_shared != nullptr)
+            return m_shared->print(out, print_literals, pretty_print, include_types, marked_index);
         std::stack<blt::size_t> arguments_left;
         blt::size_t indent = 0;
 
@@ -81,20 +86,21 @@ namespace blt::gp
                     copy.transfer_bytes(reversed, v.type_size());
             }
         }
+        const auto& table = m_program->get_operator_table();
         for (const auto& [i, v] : enumerate(operations))
         {
-            auto info = m_program->get_operator_info(v.id());
+            const auto argc = table.argc[v.id()];
             const auto name = m_program->get_name(v.id()) ? m_program->get_name(v.id()).value() : "NULL";
-            auto return_type = get_return_type(*m_program, info.return_type, include_types);
+            auto return_type = get_return_type(*m_program, table.return_types[v.id()], include_types);
             if (static_cast<ptrdiff_t>(i) == marked_index)
             {
                 out << "[ERROR OCCURRED HERE] -> ";
             }
-            if (info.argc.argc > 0)
+            if (argc > 0)
             {
                 create_indent(out, indent, pretty_print) << "(";
                 indent++;
-                arguments_left.emplace(info.argc.argc);
+                arguments_left.emplace(argc);
                 out << name << return_type << end_indent(pretty_print);
             }
             else
@@ -102,7 +108,7 @@ namespace blt::gp
                 if (print_literals)
                 {
                     create_indent(out, indent, pretty_print);
-                    if (m_program->is_operator_ephemeral(v.id()))
+                    if (table.flags[v.id()].is_ephemeral())
                     {
                         m_program->get_print_func(v.id())(out, reversed);
                         reversed.pop_bytes(v.type_size());
@@ -156,8 +162,11 @@ namespace blt::gp
 
     size_t tree_t::get_depth(gp_program& program) const
     {
+        if (m_shared != nullptr)
+            return m_shared->get_depth(program);
         size_t depth = 0;
 
+        const auto& table = program.get_operator_table();
         auto operations_stack = operations;
         thread_local tracked_vector<size_t> values_process;
         thread_local tracked_vector<size_t> value_stack;
@@ -185,13 +194,13 @@ namespace blt::gp
                 continue;
             }
             size_t local_depth = 0;
-            for (size_t i = 0; i < program.get_operator_info(operation.id()).argc.argc; i++)
+            for (size_t i = 0; i < table.argc[operation.id()]; i++)
             {
                 local_depth = std::max(local_depth, values_process.back());
                 values_process.pop_back();
             }
             value_stack.push_back(local_depth + 1);
-            operations_stack.emplace_back(operation.type_size(), operation.id(), true, program.get_operator_flags(operation.id()));
+            operations_stack.emplace_back(operation.type_size(), operation.id(), true, table.flags[operation.id()]);
         }
 
         return depth;
@@ -199,14 +208,17 @@ namespace blt::gp
 
     tree_t::subtree_point_t tree_t::select_subtree(const double terminal_chance) const
     {
+        if (m_shared != nullptr)
+            return m_shared->select_subtree(terminal_chance);
+        const auto& table = m_program->get_operator_table();
         do
         {
             const auto point = m_program->get_random().get_u64(0, operations.size());
-            const auto& info = m_program->get_operator_info(operations[point].id());
-            if (!info.argc.is_terminal())
-                return {static_cast<ptrdiff_t>(point), info.return_type};
+            const auto id = operations[point].id();
+            if (!table.is_terminal(id))
+                return {static_cast<ptrdiff_t>(point), table.return_types[id]};
             if (m_program->get_random().choice(terminal_chance))
-                return {static_cast<ptrdiff_t>(point), info.return_type};
+                return {static_cast<ptrdiff_t>(point), table.return_types[id]};
         }
         while (true);
     }
@@ -223,25 +235,28 @@ namespace blt::gp
 
     tree_t::subtree_point_t tree_t::select_subtree_traverse(const double terminal_chance, const double depth_multiplier) const
     {
+        if (m_shared != nullptr)
+            return m_shared->select_subtree_traverse(terminal_chance, depth_multiplier);
         size_t index = 0;
         double depth = 0;
         double exit_chance = 0;
+        const auto& table = m_program->get_operator_table();
         while (true)
         {
-            const auto& info = m_program->get_operator_info(operations[index].id());
-            if (info.argc.is_terminal())
+            const auto id = operations[index].id();
+            if (table.is_terminal(id))
             {
                 if (m_program->get_random().choice(terminal_chance))
-                    return {static_cast<ptrdiff_t>(index), info.return_type};
+                    return {static_cast<ptrdiff_t>(index), table.return_types[id]};
                 index = 0;
                 depth = 0;
                 exit_chance = 0;
                 continue;
             }
             if (m_program->get_random().choice(exit_chance))
-                return {static_cast<ptrdiff_t>(index), info.return_type};
+                return {static_cast<ptrdiff_t>(index), table.return_types[id]};
 
-            const auto child = m_program->get_random().get_u32(0, info.argc.argc);
+            const auto child = m_program->get_random().get_u32(0, table.argc[id]);
             index++;
             for (u32 i = 0; i < child; i++)
                 index = find_endpoint(static_cast<ptrdiff_t>(index));
@@ -262,8 +277,10 @@ namespace blt::gp
         return {};
     }
 
-    void tree_t::copy_subtree(const subtree_point_t point, const ptrdiff_t extent, tracked_vector<op_container_t>& operators, stack_allocator& stack)
+    void tree_t::copy_subtree(const subtree_point_t point, const ptrdiff_t extent, op_vector_t& operators, stack_allocator& stack)
     {
+        if (m_shared != nullptr)
+            return m_shared->copy_subtree(point, extent, operators, stack);
         const auto point_begin_itr = operations.begin() + point.pos;
         const auto point_end_itr = operations.begin() + extent;
 
@@ -295,14 +312,16 @@ namespace blt::gp
 
     void tree_t::swap_subtrees(const child_t our_subtree, tree_t& other_tree, const child_t other_subtree)
     {
+        detach();
+        other_tree.detach();
         const auto c1_subtree_begin_itr = operations.begin() + our_subtree.start;
         const auto c1_subtree_end_itr = operations.begin() + our_subtree.end;
 
         const auto c2_subtree_begin_itr = other_tree.operations.begin() + other_subtree.start;
         const auto c2_subtree_end_itr = other_tree.operations.begin() + other_subtree.end;
 
-        thread_local tracked_vector<op_container_t> c1_subtree_operators;
-        thread_local tracked_vector<op_container_t> c2_subtree_operators;
+        thread_local op_vector_t c1_subtree_operators;
+        thread_local op_vector_t c2_subtree_operators;
         c1_subtree_operators.clear();
         c2_subtree_operators.clear();
 
@@ -384,6 +403,8 @@ namespace blt::gp
 
     void tree_t::replace_subtree(const subtree_point_t point, const ptrdiff_t extent, tree_t& other_tree)
     {
+        detach();
+        const auto& other = other_tree.storage();
         const auto point_begin_itr = operations.begin() + point.pos;
         const auto point_end_itr = operations.begin() + extent;
 
@@ -411,26 +432,27 @@ namespace blt::gp
         values.pop_bytes(after_bytes + for_bytes);
 
         size_t copy_bytes = 0;
-        for (const auto& v : other_tree.operations)
+        for (const auto& v : other.operations)
         {
             if (v.is_value())
             {
                 if (v.get_flags().is_ephemeral() && v.has_ephemeral_drop())
                 {
-                    auto [_, pointer] = other_tree.values.access_pointer_forward(copy_bytes, v.type_size());
+                    auto [_, pointer] = other.values.access_pointer_forward(copy_bytes, v.type_size());
                     ++*pointer;
                 }
                 copy_bytes += v.type_size();
             }
-            insert = ++operations.emplace(insert, v);
+            insert = operations.emplace(insert, v) + 1;
         }
 
-        values.insert(other_tree.values);
+        values.insert(other.values);
         values.copy_from(ptr, after_bytes);
     }
 
     void tree_t::delete_subtree(const subtree_point_t point, const ptrdiff_t extent)
     {
+        detach();
         const auto point_begin_itr = operations.begin() + point.pos;
         const auto point_end_itr = operations.begin() + extent;
 
@@ -461,42 +483,47 @@ namespace blt::gp
 
     ptrdiff_t tree_t::insert_subtree(const subtree_point_t point, tree_t& other_tree)
     {
+        detach();
+        const auto& other = other_tree.storage();
         const size_t after_bytes = accumulate_type_sizes(operations.begin() + point.pos, operations.end());
         byte_only_transaction_t transaction{*this, after_bytes};
 
         auto insert = operations.begin() + point.pos;
         size_t bytes = 0;
-        for (auto& it : iterate(other_tree.operations).rev())
+        for (auto& it : iterate(other.operations).rev())
         {
             if (it.is_value())
             {
                 bytes += it.type_size();
                 if (it.get_flags().is_ephemeral() && it.has_ephemeral_drop())
                 {
-                    auto [_, ptr] = other_tree.values.access_pointer(bytes, it.type_size());
+                    auto [_, ptr] = other.values.access_pointer(bytes, it.type_size());
                     ++*ptr;
                 }
             }
             insert = operations.insert(insert, it);
         }
-        values.insert(other_tree.values);
+        values.insert(other.values);
 
-        return static_cast<ptrdiff_t>(point.pos + other_tree.size());
+        return static_cast<ptrdiff_t>(point.pos + other.size());
     }
 
 
     ptrdiff_t tree_t::find_endpoint(ptrdiff_t start) const
     {
+        if (m_shared != nullptr)
+            return m_shared->find_endpoint(start);
         i64 children_left = 0;
+        const auto& argc = m_program->get_operator_table().argc;
 
         do
         {
-            const auto& type = m_program->get_operator_info(operations[start].id());
+            const auto op_argc = argc[operations[start].id()];
             // this is a child to someone
             if (children_left != 0)
                 children_left--;
-            if (type.argc.argc > 0)
-                children_left += type.argc.argc;
+            if (op_argc > 0)
+                children_left += op_argc;
             start++;
         }
         while (children_left > 0);
@@ -513,11 +540,12 @@ namespace blt::gp
 
     void tree_t::handle_operator_inserted(const op_container_t& op)
     {
-        if (m_program->is_operator_ephemeral(op.id()))
+        // the container already carries the operator's flags, no need to look them up again
+        if (op.get_flags().is_ephemeral())
         {
             // Ephemeral values have corresponding insertions into the stack
             m_program->get_operator_info(op.id()).func(nullptr, values, values);
-            if (m_program->operator_has_ephemeral_drop(op.id()))
+            if (op.has_ephemeral_drop())
             {
                 auto [_, ptr] = values.access_pointer(op.type_size(), op.type_size());
                 ptr = new std::atomic_uint64_t(1);
@@ -535,11 +563,13 @@ namespace blt::gp
 
     evaluation_context& tree_t::evaluate(void* ptr) const
     {
-        return m_program->get_eval_func()(*this, ptr);
+        return m_program->get_eval_func()(storage(), ptr);
     }
 
     bool tree_t::check(void* context) const
     {
+        if (m_shared != nullptr)
+            return m_shared->check(context);
         size_t bytes_expected = 0;
         const auto bytes_size = values.stored();
 
@@ -640,6 +670,8 @@ namespace blt::gp
         auto* f = &program;
         if (&program != m_program)
             m_program = f;
+        if (m_shared != nullptr)
+            release_shared(false);
         size_t total_bytes = 0;
         for (const auto& op : iterate(operations))
         {
@@ -659,8 +691,65 @@ namespace blt::gp
         values.reset();
     }
 
+    void tree_t::clear_storage()
+    {
+        clear(*m_program);
+        operations = op_vector_t{operations.get_allocator()};
+        values = stack_allocator{values.get_arena()};
+    }
+
+    void tree_t::share(const tree_t& source)
+    {
+        if (source.m_shared == nullptr)
+        {
+            copy_fast(source);
+            return;
+        }
+        if (source.m_shared == m_shared)
+            return;
+        clear(*m_program);
+        m_shared = source.m_shared;
+    }
+
+    void tree_t::make_shareable()
+    {
+        if (m_shared != nullptr || get_arena() != nullptr)
+            return;
+        m_shared = std::make_shared<tree_t>(std::move(*this));
+    }
+
+    void tree_t::release_shared(const bool copy_contents)
+    {
+        auto shared = std::move(m_shared);
+        // the block is only reachable through the trees referencing it, if we are the last one nobody else can be reading it.
+        // arena trees never take it back, the block's buffers are heap allocated.
+        if (shared.use_count() == 1 && get_arena() == nullptr)
+        {
+            // pairs with the release done by the other trees dropping their reference
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::swap(operations, shared->operations);
+            std::swap(values, shared->values);
+            return;
+        }
+        if (copy_contents)
+            copy_fast(*shared);
+    }
+
+    void tree_t::set_arena(tree_arena_t* arena)
+    {
+        detach();
+        if (arena == get_arena())
+            return;
+        op_vector_t moved_operations{arena_allocator_t<op_container_t>{arena}};
+        moved_operations.reserve(operations.size());
+        moved_operations.insert(moved_operations.end(), operations.begin(), operations.end());
+        operations = std::move(moved_operations);
+        values.set_arena(arena);
+    }
+
     void tree_t::insert_operator(const size_t index, const op_container_t& container)
     {
+        detach();
         if (container.get_flags().is_ephemeral())
         {
             byte_only_transaction_t move{*this, total_value_bytes(index)};
@@ -671,7 +760,7 @@ namespace blt::gp
 
     tree_t::subtree_point_t tree_t::subtree_from_point(ptrdiff_t point) const
     {
-        return {point, m_program->get_operator_info(operations[point].id()).return_type};
+        return {point, m_program->get_operator_table().return_types[storage().operations[point].id()]};
     }
 
     void tree_t::regen(tree_generator_t& generator, const type_id root_type, const size_t min_depth, const size_t max_depth)
@@ -682,12 +771,16 @@ namespace blt::gp
 
     size_t tree_t::required_size() const
     {
+        if (m_shared != nullptr)
+            return m_shared->required_size();
         // 2 size_t used to store expected_length of operations + size of the values stack
         return 2 * sizeof(size_t) + operations.size() * sizeof(size_t) + values.stored();
     }
 
     void tree_t::to_byte_array(std::byte* out) const
     {
+        if (m_shared != nullptr)
+            return m_shared->to_byte_array(out);
         const auto op_size = operations.size();
         std::memcpy(out, &op_size, sizeof(size_t));
         out += sizeof(size_t);
@@ -706,6 +799,8 @@ namespace blt::gp
 
     void tree_t::to_file(fs::writer_t& file) const
     {
+        if (m_shared != nullptr)
+            return m_shared->to_file(file);
         const auto op_size = operations.size();
         BLT_ASSERT(file.write(&op_size, sizeof(size_t)) == sizeof(size_t));
         for (const auto& op : operations)
@@ -720,6 +815,7 @@ namespace blt::gp
 
     void tree_t::from_byte_array(const std::byte* in)
     {
+        detach();
         size_t ops_to_read;
         std::memcpy(&ops_to_read, in, sizeof(size_t));
         in += sizeof(size_t);
@@ -729,12 +825,7 @@ namespace blt::gp
             operator_id id;
             std::memcpy(&id, in, sizeof(operator_id));
             in += sizeof(operator_id);
-            operations.emplace_back(
-                m_program->get_typesystem().get_type(m_program->get_operator_info(id).return_type).size(),
-                id,
-                m_program->is_operator_ephemeral(id),
-                m_program->get_operator_flags(id)
-            );
+            operations.push_back(m_program->get_operator_container(id));
         }
         size_t val_size;
         std::memcpy(&val_size, in, sizeof(size_t));
@@ -745,6 +836,7 @@ namespace blt::gp
 
     void tree_t::from_file(fs::reader_t& file)
     {
+        detach();
         size_t ops_to_read;
         BLT_ASSERT(file.read(&ops_to_read, sizeof(size_t)) == sizeof(size_t));
         operations.reserve(ops_to_read);
@@ -752,12 +844,7 @@ namespace blt::gp
         {
             operator_id id;
             BLT_ASSERT(file.read(&id, sizeof(operator_id)) == sizeof(operator_id));
-            operations.emplace_back(
-                m_program->get_typesystem().get_type(m_program->get_operator_info(id).return_type).size(),
-                id,
-                m_program->is_operator_ephemeral(id),
-                m_program->get_operator_flags(id)
-            );
+            operations.push_back(m_program->get_operator_container(id));
         }
         size_t bytes_in_head;
         BLT_ASSERT(file.read(&bytes_in_head, sizeof(size_t)) == sizeof(size_t));
@@ -765,10 +852,9 @@ namespace blt::gp
         BLT_ASSERT(file.read(values.data(), bytes_in_head) == static_cast<i64>(bytes_in_head));
     }
 
-    void tree_t::modify_operator(const size_t point, operator_id new_id, std::optional<type_id> return_type)
+    void tree_t::modify_operator(const size_t point, operator_id new_id, std::optional<type_id>)
     {
-        if (!return_type)
-            return_type = m_program->get_operator_info(new_id).return_type;
+        detach();
         byte_only_transaction_t move_data{*this};
         if (operations[point].is_value())
         {
@@ -783,12 +869,7 @@ namespace blt::gp
             }
             values.pop_bytes(operations[point].type_size());
         }
-        operations[point] = {
-            m_program->get_typesystem().get_type(*return_type).size(),
-            new_id,
-            m_program->is_operator_ephemeral(new_id),
-            m_program->get_operator_flags(new_id)
-        };
+        operations[point] = m_program->get_operator_container(new_id);
         if (operations[point].get_flags().is_ephemeral())
         {
             if (move_data.empty())
@@ -800,8 +881,20 @@ namespace blt::gp
         }
     }
 
+    size_t tree_t::structural_hash() const
+    {
+        if (m_shared != nullptr)
+            return m_shared->structural_hash();
+        size_t hash = operations.size();
+        for (const auto& op : operations)
+            hash ^= static_cast<size_t>(op.id()) + 0x9E3779B97F4A7C15ul + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
     bool operator==(const tree_t& a, const tree_t& b)
     {
+        if (a.m_shared != nullptr || b.m_shared != nullptr)
+            return a.storage() == b.storage();
         if (a.operations.size() != b.operations.size())
             return false;
         if (a.values.stored() != b.values.stored())
@@ -818,4 +911,142 @@ namespace blt::gp
     {
         return a.tree == b.tree;
     }
+
+    void population_t::enable_arena(const size_t block_size)
+    {
+        if (arena != nullptr)
+            return;
+        arena = std::make_unique<tree_arena_t>(block_size);
+        for (auto& individual : individuals)
+            individual.tree.set_arena(arena.get());
+    }
+
+    void population_t::disable_arena()
+    {
+        if (arena == nullptr)
+            return;
+        for (auto& individual : individuals)
+            individual.tree.set_arena(nullptr);
+        arena.reset();
+    }
+
+    void population_t::make_shareable()
+    {
+        for (auto& individual : individuals)
+            individual.tree.make_shareable();
+    }
+
+    void population_t::reset_arena()
+    {
+        if (arena == nullptr)
+            return;
+        for (auto& individual : individuals)
+            individual.tree.clear_storage();
+        arena->reset();
+    }
+
+    void population_t::reset_fitness()
+    {
+        const auto size = individuals.size();
+        raw_fitness.assign(size, 0);
+        standardized_fitness.assign(size, 0);
+        adjusted_fitness.assign(size, 0);
+        hits.assign(size, 0);
+    }
+
+    void population_t::rank_by_fitness(const size_t count)
+    {
+        begin_ranking(count, 1);
+        rank_slice(0);
+        finish_ranking();
+    }
+
+    void population_t::begin_ranking(const size_t count, const size_t thread_count)
+    {
+        rank_count = std::min(count, individuals.size());
+        // every slice must hold at least one individual for the merge lengths to work out
+        rank_slices = std::max<size_t>(1, std::min(thread_count, individuals.size()));
+        ranking.resize(individuals.size());
+    }
+
+    void population_t::rank_slice(const size_t thread_id)
+    {
+        if (thread_id >= rank_slices)
+            return;
+        const auto begin = ranking.begin() + static_cast<ptrdiff_t>(slice_begin(thread_id));
+        const auto end = ranking.begin() + static_cast<ptrdiff_t>(slice_begin(thread_id + 1));
+        const auto middle = begin + static_cast<ptrdiff_t>(ranked_length(thread_id, 1));
+        std::iota(begin, end, slice_begin(thread_id));
+        const auto compare = [this](const size_t a, const size_t b) {
+            return ranks_before(a, b);
+        };
+        // only the best rank_count of each slice can end up in the ranking
+        if (middle != end)
+            std::nth_element(begin, middle, end, compare);
+        std::sort(begin, middle, compare);
+    }
+
+    void population_t::merge_ranked_slices(const size_t thread_id, const size_t step)
+    {
+        if (thread_id % (step * 2) != 0 || thread_id + step >= rank_slices)
+            return;
+        thread_local tracked_vector<size_t> merged;
+        const auto first = ranking.begin() + static_cast<ptrdiff_t>(slice_begin(thread_id));
+        const auto second = ranking.begin() + static_cast<ptrdiff_t>(slice_begin(thread_id + step));
+        const auto first_end = first + static_cast<ptrdiff_t>(ranked_length(thread_id, step));
+        const auto second_end = second + static_cast<ptrdiff_t>(ranked_length(thread_id + step, step));
+        merged.resize(ranked_length(thread_id, step * 2));
+
+        auto a = first;
+        auto b = second;
+        for (auto& index : merged)
+        {
+            if (b == second_end || (a != first_end && ranks_before(*a, *b)))
+                index = *a++;
+            else
+                index = *b++;
+        }
+        std::copy(merged.begin(), merged.end(), first);
+    }
+
+    void population_t::finish_ranking()
+    {
+        ranking.resize(ranked_length(0, rank_slices));
+    }
+
+    void population_t::update_ranking(const tracked_vector<size_t>& changed)
+    {
+        if (ranking.size() != individuals.size())
+        {
+            rank_by_fitness(rank_count);
+            return;
+        }
+        thread_local tracked_vector<u8> is_changed;
+        thread_local tracked_vector<size_t> sorted_changed;
+        thread_local tracked_vector<size_t> kept;
+        is_changed.resize(individuals.size());
+        sorted_changed.clear();
+        kept.clear();
+        for (const auto index : changed)
+        {
+            if (is_changed[index])
+                continue;
+            is_changed[index] = true;
+            sorted_changed.push_back(index);
+        }
+        for (const auto index : ranking)
+        {
+            if (!is_changed[index])
+                kept.push_back(index);
+        }
+        for (const auto index : sorted_changed)
+            is_changed[index] = false;
+
+        std::sort(sorted_changed.begin(), sorted_changed.end(), [this](const size_t a, const size_t b) {
+            return ranks_before(a, b);
+        });
+        std::merge(kept.begin(), kept.end(), sorted_changed.begin(), sorted_changed.end(), ranking.begin(), [this](const size_t a, const size_t b) {
+            return ranks_before(a, b);
+        });
+    }
 }
@@ -180,7 +180,7 @@ int main()
         program.evaluate_fitness();
     }
 
-    // program.get_best_individuals<1>()[0].get().tree.print(program, std::cout, true, true);
+    // program.get_best_individuals<1>()[0].tree.print(program, std::cout, true, true);
 
     regression.get_program().get_current_pop().clear();
     regression.get_program().next_generation();
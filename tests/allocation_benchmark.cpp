@@ -0,0 +1,71 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// counts the allocations made by every full generation (breeding and evaluation) of the symbolic regression example, on all threads.
+// build with BLT_GP_USE_SYSTEM_ALLOCATOR to compare timings against the system allocator.
+
+using namespace blt::gp;
+
+static const auto SEED_FUNC = [] { return std::random_device()(); };
+
+const auto config = prog_config_t()
+                    .set_initial_min_tree_size(2)
+                    .set_initial_max_tree_size(6)
+                    .set_elite_count(2)
+                    .set_crossover_chance(0.8)
+                    .set_mutation_chance(0.1)
+                    .set_reproduction_chance(0.1)
+                    .set_max_generations(20)
+                    .set_pop_size(10000)
+                    .set_thread_count(0);
+
+int main()
+{
+    example::symbolic_regression_t regression{SEED_FUNC, config};
+    regression.setup_operations();
+    regression.generate_initial_population();
+    auto& program = regression.get_program();
+
+#ifndef BLT_GP_USE_SYSTEM_ALLOCATOR
+    auto previous = slab_allocator_t::get_stats();
+#endif
+    double total_time = 0;
+    while (!program.should_terminate())
+    {
+        const auto start = std::chrono::steady_clock::now();
+        program.create_next_generation();
+        program.next_generation();
+        program.evaluate_fitness();
+        const auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total_time += time;
+
+        std::cout << "Generation " << program.get_current_generation() << ": " << time << "s";
+#ifndef BLT_GP_USE_SYSTEM_ALLOCATOR
+        const auto stats = slab_allocator_t::get_stats();
+        std::cout << ", " << stats.allocations - previous.allocations << " allocations, " << stats.system_allocations - previous.
+            system_allocations << " from the system, " << stats.remote_frees - previous.remote_frees << " freed by another thread";
+        previous = stats;
+#endif
+        std::cout << '\n';
+    }
+    std::cout << "Total: " << total_time << "s, best fitness " << program.get_population_stats().best_fitness.load() << std::endl;
+}
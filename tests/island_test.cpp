@@ -0,0 +1,242 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/island.h>
+#include <blt/gp/program.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+// checks the neighbours of every topology, the migration queues, and that migration keeps the elites, statistics and ranking of the receiving
+// island intact. the islands are migrated by hand so the test does not depend on how the threads are scheduled.
+
+using namespace blt::gp;
+
+constexpr size_t ELITES = 3;
+
+const auto config = prog_config_t()
+                    .set_initial_min_tree_size(2)
+                    .set_initial_max_tree_size(6)
+                    .set_elite_count(ELITES)
+                    .set_pop_size(20)
+                    .set_thread_count(1);
+
+void expect(const bool condition, const char* message)
+{
+    if (!condition)
+    {
+        BLT_ERROR("Island test failed: {}", message);
+        std::exit(1);
+    }
+}
+
+std::vector<std::unique_ptr<example::symbolic_regression_t>> make_islands(const size_t count)
+{
+    std::vector<std::unique_ptr<example::symbolic_regression_t>> islands;
+    for (size_t i = 0; i < count; i++)
+    {
+        islands.push_back(std::make_unique<example::symbolic_regression_t>(691ul + i, config));
+        // migrants keep their fitness, so every island has to evaluate on the same data
+        islands.back()->set_training_cases(islands.front()->get_training_cases());
+        islands.back()->setup_operations();
+        islands.back()->generate_initial_population();
+    }
+    return islands;
+}
+
+std::vector<gp_program*> programs_of(const std::vector<std::unique_ptr<example::symbolic_regression_t>>& islands, const size_t count)
+{
+    std::vector<gp_program*> programs;
+    for (size_t i = 0; i < count; i++)
+        programs.push_back(&islands[i]->get_program());
+    return programs;
+}
+
+void expect_neighbours(const island_model_t& model, const size_t island, std::vector<size_t> expected)
+{
+    auto neighbours = model.get_neighbours(island);
+    std::sort(neighbours.begin(), neighbours.end());
+    std::sort(expected.begin(), expected.end());
+    if (neighbours != expected)
+    {
+        BLT_ERROR("Island {} has {} neighbours, expected {}", island, neighbours.size(), expected.size());
+        std::exit(1);
+    }
+}
+
+void test_topologies(const std::vector<std::unique_ptr<example::symbolic_regression_t>>& islands)
+{
+    using topology_t = island_model_t::topology_t;
+    {
+        const island_model_t ring{programs_of(islands, 5), island_model_t::config_t{}.set_topology(topology_t::RING)};
+        for (size_t i = 0; i < 5; i++)
+            expect_neighbours(ring, i, {(i + 1) % 5});
+    }
+    {
+        const island_model_t full{programs_of(islands, 4), island_model_t::config_t{}.set_topology(topology_t::FULLY_CONNECTED)};
+        expect_neighbours(full, 0, {1, 2, 3});
+        expect_neighbours(full, 2, {0, 1, 3});
+    }
+    {
+        // 6 islands default to a grid 2 wide and 3 high, the left and right neighbours are the same island
+        const island_model_t torus{programs_of(islands, 6), island_model_t::config_t{}.set_topology(topology_t::TORUS)};
+        expect_neighbours(torus, 0, {1, 2, 4});
+        expect_neighbours(torus, 3, {2, 5, 1});
+    }
+    {
+        // 3 islands only divide into a single column, which never has neighbours to the side
+        const island_model_t torus{programs_of(islands, 3), island_model_t::config_t{}.set_topology(topology_t::TORUS)};
+        expect_neighbours(torus, 0, {1, 2});
+        expect_neighbours(torus, 1, {0, 2});
+    }
+    {
+        // a single row never has neighbours above or below
+        const island_model_t torus{programs_of(islands, 4), island_model_t::config_t{}.set_topology(topology_t::TORUS).set_torus_width(4)};
+        expect_neighbours(torus, 0, {1, 3});
+        expect_neighbours(torus, 2, {1, 3});
+    }
+    {
+        const island_model_t torus{programs_of(islands, 2), island_model_t::config_t{}.set_topology(topology_t::TORUS)};
+        expect_neighbours(torus, 0, {1});
+        expect_neighbours(torus, 1, {0});
+    }
+    for (const auto topology : {topology_t::RING, topology_t::TORUS, topology_t::FULLY_CONNECTED})
+    {
+        const island_model_t single{programs_of(islands, 1), island_model_t::config_t{}.set_topology(topology)};
+        expect_neighbours(single, 0, {});
+    }
+}
+
+void test_queue(gp_program& program)
+{
+    constexpr size_t CAPACITY = 3;
+    island_model_t::migration_queue_t queue{program, CAPACITY};
+    expect(queue.front() == nullptr, "empty queue returned a migrant");
+    size_t pushed = 0;
+    size_t popped = 0;
+    // several rounds of partially filling and draining, so the indices wrap around the slots many times
+    for (size_t round = 0; round < 10; round++)
+    {
+        while (auto* migrant = queue.back())
+        {
+            migrant->fitness.adjusted_fitness = static_cast<double>(pushed++);
+            queue.push();
+        }
+        expect(queue.size() == CAPACITY, "full queue has the wrong size");
+        for (size_t i = 0; i < 1 + round % CAPACITY; i++)
+        {
+            const auto* migrant = queue.front();
+            expect(migrant != nullptr, "queue lost a migrant");
+            expect(migrant->fitness.adjusted_fitness == static_cast<double>(popped++), "queue is not first in first out");
+            queue.pop();
+        }
+    }
+    while (const auto* migrant = queue.front())
+    {
+        expect(migrant->fitness.adjusted_fitness == static_cast<double>(popped++), "queue is not first in first out");
+        queue.pop();
+    }
+    expect(popped == pushed && queue.size() == 0, "queue did not return every migrant");
+}
+
+void test_dropping(const std::vector<std::unique_ptr<example::symbolic_regression_t>>& islands)
+{
+    island_model_t model{programs_of(islands, 2), island_model_t::config_t{}.set_migrants(4).set_queued_migrations(1)};
+    model.migrate(0);
+    expect(model.get_dropped_migrants(1) == 0, "migrants were dropped from an empty queue");
+    // island 1 has not taken the first migration yet, so the second does not fit
+    model.migrate(0);
+    expect(model.get_dropped_migrants(1) == 4, "full queue did not drop the migrants");
+    model.migrate(1);
+    expect(model.get_immigrants(1) == 4, "island did not receive the queued migrants");
+    model.migrate(0);
+    expect(model.get_immigrants(0) == 4, "island did not receive its neighbour's migrants");
+    expect(model.get_dropped_migrants(1) == 4, "migrants were dropped from a drained queue");
+}
+
+void verify_island(example::symbolic_regression_t& regression)
+{
+    auto& program = regression.get_program();
+    auto& pop = program.get_current_pop();
+    const auto& fitness = pop.get_adjusted_fitness();
+    for (size_t i = 0; i < fitness.size(); i++)
+    {
+        fitness_t fit{};
+        regression.get_fitness_function()(pop.get_individuals()[i].tree, fit, i);
+        expect(fit.adjusted_fitness == fitness[i], "individual's fitness does not belong to its tree");
+    }
+
+    std::vector<size_t> expected(fitness.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [&fitness](const size_t a, const size_t b) {
+        return fitness[a] > fitness[b];
+    });
+    const auto& ranking = pop.get_ranking();
+    expect(!ranking.empty() && std::equal(ranking.begin(), ranking.end(), expected.begin()), "ranking does not match the population");
+
+    const auto& stats = program.get_population_stats();
+    const auto overall = std::accumulate(fitness.begin(), fitness.end(), 0.0);
+    expect(std::abs(stats.overall_fitness - overall) <= 1e-9 * std::abs(overall) + 1e-12, "overall fitness does not match the population");
+    expect(std::abs(stats.average_fitness - overall / static_cast<double>(fitness.size())) <= 1e-9, "average fitness does not match");
+    expect(stats.best_fitness == *std::max_element(fitness.begin(), fitness.end()), "best fitness does not match the population");
+    expect(stats.worst_fitness == *std::min_element(fitness.begin(), fitness.end()), "worst fitness does not match the population");
+}
+
+void test_replacement(const island_model_t::replacement_policy_t replacement, const island_model_t::emigrant_policy_t emigrants)
+{
+    auto islands = make_islands(3);
+    // more migrants arrive than there are individuals outside of the elites
+    island_model_t model{
+        programs_of(islands, 3),
+        island_model_t::config_t{}.set_topology(island_model_t::topology_t::FULLY_CONNECTED).set_migrants(15).set_replacement_policy(replacement).
+                                   set_emigrant_policy(emigrants)
+    };
+    model.migrate(1);
+    model.migrate(2);
+
+    auto& pop = islands[0]->get_program().get_current_pop();
+    const std::vector<size_t> elites(pop.get_ranking().begin(), pop.get_ranking().begin() + ELITES);
+    std::vector<tree_t> elite_trees;
+    for (const auto index : elites)
+        elite_trees.push_back(pop.get_individuals()[index].tree);
+
+    model.migrate(0);
+    expect(model.get_immigrants(0) == config.population_size - ELITES, "island did not fill every non elite individual with migrants");
+    for (size_t i = 0; i < ELITES; i++)
+        expect(pop.get_individuals()[elites[i]].tree == elite_trees[i], "migrant replaced an elite");
+    for (auto& island : islands)
+        verify_island(*island);
+}
+
+int main()
+{
+    const auto islands = make_islands(6);
+    test_topologies(islands);
+    test_queue(islands[0]->get_program());
+    test_dropping(islands);
+    for (const auto replacement : {island_model_t::replacement_policy_t::WORST, island_model_t::replacement_policy_t::RANDOM})
+    {
+        for (const auto emigrants : {island_model_t::emigrant_policy_t::BEST, island_model_t::emigrant_policy_t::RANDOM})
+            test_replacement(replacement, emigrants);
+    }
+    BLT_INFO("Island model tests passed");
+}
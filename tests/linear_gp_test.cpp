@@ -0,0 +1,221 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/linear.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// evaluates hand written linear programs against known values, checks which instructions are found to be effective, and checks that
+// crossover, mutation and breeding keep programs well typed and inside their length limits. ends with a short evolution run on the
+// symbolic regression example using the same operators as the tree representation.
+
+using namespace blt::gp;
+using context = example::symbolic_regression_t::context;
+using instruction_t = linear_program_t::instruction_t;
+
+constexpr size_t REGISTERS = 4;
+
+const auto config = prog_config_t()
+                    .set_initial_min_tree_size(2)
+                    .set_initial_max_tree_size(6)
+                    .set_elite_count(2)
+                    .set_crossover_chance(0.8)
+                    .set_mutation_chance(0.1)
+                    .set_reproduction_chance(0.1)
+                    .set_max_generations(10)
+                    .set_pop_size(23)
+                    .set_thread_count(1);
+
+void expect(const bool condition, const char* message)
+{
+    if (!condition)
+    {
+        BLT_ERROR("Linear GP test failed: {}", message);
+        std::exit(1);
+    }
+}
+
+operator_id find_operator(gp_program& program, const std::string_view name)
+{
+    const auto type = program.get_typesystem().get_type<float>().id();
+    for (const auto& operators : {program.get_type_terminals(type), program.get_type_non_terminals(type)})
+    {
+        for (const auto id : operators)
+        {
+            if (program.get_name(id) == name)
+                return id;
+        }
+    }
+    BLT_ERROR("Operator {} does not exist!", name);
+    std::exit(1);
+}
+
+instruction_t make_instruction(gp_program& program, const std::string_view name, const blt::u16 destination,
+                               const std::vector<blt::u16>& arguments = {})
+{
+    instruction_t instruction{};
+    instruction.id = find_operator(program, name);
+    instruction.destination = destination;
+    instruction.argc = static_cast<blt::u16>(arguments.size());
+    for (size_t i = 0; i < arguments.size(); i++)
+        instruction.arguments[i] = arguments[i];
+    return instruction;
+}
+
+instruction_t make_constant(gp_program& program, const blt::u16 destination, const float value)
+{
+    auto instruction = make_instruction(program, "lit", destination);
+    std::memcpy(instruction.constant.data(), &value, sizeof(value));
+    return instruction;
+}
+
+// every instruction must use registers which exist and the argument count of its operator, and the effective set must be up to date
+void expect_valid(const linear_program_t& program, const size_t min_length, const size_t max_length)
+{
+    expect(program.size() >= min_length && program.size() <= max_length, "program is outside of its length limits");
+    for (const auto& instruction : program.get_instructions())
+    {
+        const auto& info = program.get_program().get_operator_info(instruction.id);
+        expect(instruction.argc == info.argument_types.size(), "instruction does not match the argument count of its operator");
+        expect(instruction.destination < program.get_layout().registers_per_type, "instruction writes to a register which does not exist");
+        for (size_t a = 0; a < instruction.argc; a++)
+            expect(instruction.arguments[a] < program.get_layout().registers_per_type, "instruction reads a register which does not exist");
+    }
+    auto copy = program;
+    copy.update_effective();
+    expect(copy.get_effective() == program.get_effective(), "effective instructions were not updated");
+}
+
+void test_evaluation(gp_program& program, const linear_layout_t& layout)
+{
+    linear_program_t linear{program, layout};
+    auto& instructions = linear.get_instructions();
+    // f0 = x * x + 2, with a dead write to the output and an instruction whose result is never read
+    instructions.push_back(make_instruction(program, "x", 0));
+    instructions.push_back(make_instruction(program, "x", 1));
+    instructions.push_back(make_instruction(program, "sin", 3, {1}));
+    instructions.push_back(make_instruction(program, "mul", 2, {1, 1}));
+    instructions.push_back(make_constant(program, 3, 2.0f));
+    instructions.push_back(make_instruction(program, "add", 0, {2, 3}));
+    linear.update_effective();
+
+    const std::vector<blt::u32> effective{1, 3, 4, 5};
+    expect(std::equal(effective.begin(), effective.end(), linear.get_effective().begin(), linear.get_effective().end()),
+           "wrong instructions were found to be effective");
+    for (const float x : {-2.0f, 0.0f, 0.5f, 3.0f})
+        expect(linear.get_evaluation_value<float>(context{x, 0}) == x * x + 2.0f, "program does not evaluate to x * x + 2");
+
+    // registers which are never written read as zero, so f0 = x - (0 / x) protected against the division by zero
+    instructions.clear();
+    instructions.push_back(make_instruction(program, "x", 1));
+    instructions.push_back(make_instruction(program, "div", 2, {3, 1}));
+    instructions.push_back(make_instruction(program, "sub", 0, {1, 2}));
+    linear.update_effective();
+    expect(linear.effective_size() == 3, "every instruction of the second program is effective");
+    expect(linear.get_evaluation_value<float>(context{0, 0}) == 0.0f, "division by a zero register was not protected");
+    expect(linear.get_evaluation_value<float>(context{4, 0}) == 4.0f, "unwritten register was not zero");
+
+    // nothing writes the output register
+    instructions.pop_back();
+    linear.update_effective();
+    expect(linear.effective_size() == 0, "program without an output has effective instructions");
+    expect(linear.get_evaluation_value<float>(context{4, 0}) == 0.0f, "output register was not zero");
+}
+
+void test_operators(gp_program& program, const linear_layout_t& layout)
+{
+    constexpr size_t MIN_LENGTH = 3;
+    constexpr size_t MAX_LENGTH = 12;
+    linear_crossover_t crossover{linear_crossover_t::config_t{}.set_max_segment_length(5).set_min_program_length(MIN_LENGTH).
+                                                               set_max_program_length(MAX_LENGTH)};
+    linear_mutation_t mutation{linear_mutation_t::config_t{}.set_min_program_length(MIN_LENGTH).set_max_program_length(MAX_LENGTH)};
+
+    linear_program_t p1{program, layout};
+    linear_program_t p2{program, layout};
+    size_t crossovers = 0;
+    size_t mutations = 0;
+    for (size_t i = 0; i < 500; i++)
+    {
+        p1.generate(program.get_random().get_size_t(MIN_LENGTH, MAX_LENGTH + 1));
+        p2.generate(program.get_random().get_size_t(MIN_LENGTH, MAX_LENGTH + 1));
+        expect_valid(p1, MIN_LENGTH, MAX_LENGTH);
+
+        auto c1 = p1;
+        auto c2 = p2;
+        if (crossover.apply(program, p1, p2, c1, c2))
+        {
+            crossovers++;
+            expect(c1.size() + c2.size() == p1.size() + p2.size(), "crossover lost or duplicated instructions");
+            expect_valid(c1, MIN_LENGTH, MAX_LENGTH);
+            expect_valid(c2, MIN_LENGTH, MAX_LENGTH);
+        }
+
+        auto c = p1;
+        if (mutation.apply(program, p1, c))
+        {
+            mutations++;
+            expect_valid(c, MIN_LENGTH, MAX_LENGTH);
+        }
+    }
+    expect(crossovers > 0 && mutations > 0, "crossover or mutation never succeeded");
+}
+
+int main()
+{
+    example::symbolic_regression_t regression{691ul, config};
+    regression.setup_operations();
+    auto& program = regression.get_program();
+    const auto float_type = program.get_typesystem().get_type<float>().id();
+
+    const linear_layout_t layout{program, float_type, REGISTERS};
+    test_evaluation(program, layout);
+    test_operators(program, layout);
+
+    const auto& training_cases = regression.get_training_cases();
+    auto fitness_function = [&training_cases](const linear_program_t& current_program, fitness_t& fitness, size_t) {
+        for (auto& fitness_case : training_cases)
+            fitness.raw_fitness += std::abs(fitness_case.y - current_program.get_evaluation_value<float>(fitness_case));
+        fitness.standardized_fitness = fitness.raw_fitness;
+        fitness.adjusted_fitness = 1.0 / (1.0 + fitness.standardized_fitness);
+    };
+
+    // the population does not divide into the evaluation chunks, so crossover is also drawn at the end of a chunk
+    linear_gp_t linear{program, linear_gp_t::config_t{}.set_registers_per_type(REGISTERS)};
+    linear.generate_initial_population(float_type);
+    linear.evaluate_fitness(fitness_function);
+    double best = linear.get_population_stats().best_fitness;
+    while (!linear.should_terminate())
+    {
+        linear.create_next_generation();
+        linear.next_generation();
+        linear.evaluate_fitness(fitness_function);
+        for (const auto& ind : linear.get_current_pop())
+            expect_valid(ind.program, 1, 128);
+        // the elites are carried over unchanged
+        expect(linear.get_population_stats().best_fitness >= best, "best fitness decreased with elitism");
+        best = linear.get_population_stats().best_fitness;
+    }
+    expect(linear.get_best_individual().fitness.adjusted_fitness == best, "best individual does not match the statistics");
+
+    BLT_INFO("Linear GP tests passed, best fitness {}", best);
+}
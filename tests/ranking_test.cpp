@@ -0,0 +1,90 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/program.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// ranks the same fitness arrays split over different numbers of threads, for the elites only and for the whole population, and compares
+// each ranking against a stable sort by fitness. the fitness values are drawn from a few distinct values so ties are common.
+
+using namespace blt::gp;
+
+// runs the ranking the way the evaluation threads do, one phase at a time for every thread
+void rank_in_slices(population_t& pop, const size_t count, const size_t thread_count)
+{
+    pop.begin_ranking(count, thread_count);
+    for (size_t id = 0; id < thread_count; id++)
+        pop.rank_slice(id);
+    for (size_t step = 1; step < thread_count; step *= 2)
+    {
+        for (size_t id = 0; id < thread_count; id++)
+            pop.merge_ranked_slices(id, step);
+    }
+    pop.finish_ranking();
+}
+
+int main()
+{
+    example::symbolic_regression_t regression{691ul, prog_config_t().set_thread_count(1)};
+    regression.setup_operations();
+    auto& program = regression.get_program();
+    std::mt19937_64 engine{691};
+
+    for (const size_t size : {1ul, 2ul, 3ul, 7ul, 64ul, 1000ul})
+    {
+        population_t pop;
+        for (size_t i = 0; i < size; i++)
+            pop.get_individuals().emplace_back(tree_t{program});
+        pop.reset_fitness();
+        std::vector<double> fitness(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            fitness_t fit{};
+            fit.adjusted_fitness = static_cast<double>(std::uniform_int_distribution<int>{0, 9}(engine)) / 10.0;
+            fitness[i] = fit.adjusted_fitness;
+            pop.set_fitness(i, fit);
+        }
+
+        std::vector<size_t> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        std::stable_sort(expected.begin(), expected.end(), [&fitness](const size_t a, const size_t b) {
+            return fitness[a] > fitness[b];
+        });
+
+        for (const size_t thread_count : {1ul, 2ul, 3ul, 5ul, 8ul})
+        {
+            for (const size_t count : {1ul, 2ul, 5ul, size})
+            {
+                rank_in_slices(pop, count, thread_count);
+                const auto& ranking = pop.get_ranking();
+                const auto length = std::min(count, size);
+                if (ranking.size() != length || !std::equal(ranking.begin(), ranking.end(), expected.begin()))
+                {
+                    BLT_ERROR("Ranking the best {} of {} individuals on {} threads does not match a stable sort!", count, size, thread_count);
+                    std::exit(1);
+                }
+            }
+        }
+    }
+    BLT_INFO("Ranking matches for every thread count");
+}
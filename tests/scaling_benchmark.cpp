@@ -0,0 +1,262 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/island.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <thread>
+
+// measures how breeding and evaluation scale with the number of threads, from 1 up to 64 or the number of hardware threads.
+// the first section compares the work stealing scheduler against a single shared counter on work of uneven cost.
+// the generations are run with evaluation balanced by count, balanced by estimated cost, and fused into breeding.
+// the asynchronous steady state section places as many children as the generational runs breed, without any barriers between them.
+// the island section splits the same population into islands of 4 threads each, which only exchange migrants every few generations.
+// the last section runs generations small enough that synchronising the threads is a large part of them.
+
+using namespace blt::gp;
+
+static const auto SEED_FUNC = [] { return std::random_device()(); };
+
+constexpr size_t MAX_THREADS = 64;
+constexpr size_t WORK_ITEMS = 200000;
+constexpr size_t CHUNK_SIZE = 16;
+
+double seconds_since(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<size_t> thread_counts()
+{
+    const auto hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<size_t> counts;
+    for (size_t count = 1; count <= std::min(hardware, MAX_THREADS); count *= 2)
+        counts.push_back(count);
+    if (counts.back() != std::min(hardware, MAX_THREADS))
+        counts.push_back(std::min(hardware, MAX_THREADS));
+    return counts;
+}
+
+// the cost of an item grows with its index, like a population where the large trees are bunched together
+double uneven_work(const size_t item)
+{
+    double value = 0;
+    for (size_t i = 0; i < 1 + item / 200; i++)
+        value += std::sqrt(static_cast<double>(item + i));
+    return value;
+}
+
+template <typename Func>
+double run_threads(const size_t threads, Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; i++)
+        workers.emplace_back(func, i);
+    func(0);
+    for (auto& worker : workers)
+        worker.join();
+    return seconds_since(start);
+}
+
+int main()
+{
+    const auto counts = thread_counts();
+
+    std::cout << "Scheduling " << WORK_ITEMS << " uneven items in chunks of " << CHUNK_SIZE << "\n";
+    for (const auto threads : counts)
+    {
+        std::atomic<double> sink = 0;
+        std::atomic_uint64_t shared_left = WORK_ITEMS;
+        const auto shared_time = run_threads(threads, [&](size_t) {
+            double local = 0;
+            while (true)
+            {
+                auto end = shared_left.load(std::memory_order_relaxed);
+                size_t size;
+                do
+                {
+                    size = std::min<size_t>(end, CHUNK_SIZE);
+                } while (size > 0 && !shared_left.compare_exchange_weak(end, end - size, std::memory_order_relaxed, std::memory_order_relaxed));
+                if (size == 0)
+                    break;
+                for (auto i = end - size; i < end; i++)
+                    local += uneven_work(i);
+            }
+            sink = sink + local;
+        });
+
+        work_stealing_scheduler_t scheduler{threads};
+        scheduler.reset(WORK_ITEMS);
+        const auto stealing_time = run_threads(threads, [&](const size_t thread_index) {
+            double local = 0;
+            scheduler.for_each(thread_index, CHUNK_SIZE, [&](const size_t begin, const size_t end) {
+                for (auto i = begin; i < end; i++)
+                    local += uneven_work(i);
+            });
+            sink = sink + local;
+        });
+        std::cout << threads << " threads: shared counter " << shared_time << "s, work stealing " << stealing_time << "s with "
+            << scheduler.get_steals() << " steals\n";
+    }
+
+    std::cout << "\nSymbolic regression generations\n";
+    double single_thread_time = 0;
+    for (const auto threads : counts)
+    {
+        for (const auto mode : {"", " (cost balanced)", " (fused)"})
+        {
+            const bool balanced = mode == std::string_view{" (cost balanced)"};
+            const bool fused = mode == std::string_view{" (fused)"};
+            if (threads == 1 && balanced)
+                continue;
+            // larger trees than the defaults, so their cost varies enough for balancing by count to leave threads idle
+            const auto config = prog_config_t()
+                                .set_initial_min_tree_size(2)
+                                .set_initial_max_tree_size(8)
+                                .set_elite_count(2)
+                                .set_max_generations(10)
+                                .set_pop_size(10000)
+                                .set_evaluation_cost_balancing(balanced)
+                                .set_evaluate_while_breeding(fused)
+                                .set_thread_count(threads);
+            example::symbolic_regression_t regression{SEED_FUNC, config};
+            regression.setup_operations();
+            regression.generate_initial_population();
+            auto& program = regression.get_program();
+
+            double breed_time = 0;
+            double evaluate_time = 0;
+            double idle_time = 0;
+            while (!program.should_terminate())
+            {
+                const auto start = std::chrono::steady_clock::now();
+                program.create_next_generation();
+                program.next_generation();
+                breed_time += seconds_since(start);
+                const auto evaluate_start = std::chrono::steady_clock::now();
+                program.evaluate_fitness();
+                evaluate_time += seconds_since(evaluate_start);
+                idle_time += program.get_population_stats().evaluation_idle_time;
+            }
+            const auto total = breed_time + evaluate_time;
+            if (threads == 1 && !fused)
+                single_thread_time = total;
+            // fused generations evaluate while breeding, so their breeding time includes the evaluation
+            std::cout << threads << " threads" << mode << ": breeding " << breed_time << "s, evaluation "
+                << evaluate_time << "s, idle at the evaluation barrier " << idle_time / static_cast<double>(threads) << "s per thread, speedup "
+                << single_thread_time / total << "x\n";
+        }
+    }
+
+    std::cout << "\nAsynchronous steady state\n";
+    double single_thread_async_time = 0;
+    for (const auto threads : counts)
+    {
+        const auto config = prog_config_t()
+                            .set_initial_min_tree_size(2)
+                            .set_initial_max_tree_size(8)
+                            .set_max_generations(10)
+                            .set_pop_size(10000)
+                            .set_thread_count(threads);
+        example::symbolic_regression_t regression{SEED_FUNC, config};
+        regression.setup_operations();
+        auto& program = regression.get_program();
+        // the execution service can only be set up once, so the example's generational setup is skipped
+        program.generate_initial_population(program.get_typesystem().get_type<float>().id());
+        program.setup_async_steady_state_evaluation(regression.get_fitness_function(), config.population_size);
+
+        const auto start = std::chrono::steady_clock::now();
+        while (!program.should_terminate())
+        {
+            program.create_next_generation();
+            program.next_generation();
+            program.evaluate_fitness();
+        }
+        const auto total = seconds_since(start);
+        if (threads == 1)
+            single_thread_async_time = total;
+        std::cout << threads << " threads: " << total << "s, speedup " << single_thread_async_time / total << "x\n";
+    }
+
+    std::cout << "\nIsland model\n";
+    for (const auto threads : counts)
+    {
+        const auto islands = std::max<size_t>(threads / 4, 1);
+        const auto config = prog_config_t()
+                            .set_initial_min_tree_size(2)
+                            .set_initial_max_tree_size(8)
+                            .set_elite_count(2)
+                            .set_max_generations(10)
+                            .set_pop_size(10000 / islands)
+                            .set_thread_count(threads / islands);
+        std::vector<std::unique_ptr<example::symbolic_regression_t>> regressions;
+        std::vector<gp_program*> programs;
+        for (size_t i = 0; i < islands; i++)
+        {
+            regressions.push_back(std::make_unique<example::symbolic_regression_t>(SEED_FUNC, config));
+            // every island has to evaluate on the same data for the migrants' fitness to carry over
+            regressions.back()->set_training_cases(regressions.front()->get_training_cases());
+            regressions.back()->setup_operations();
+            regressions.back()->generate_initial_population();
+            programs.push_back(&regressions.back()->get_program());
+        }
+        island_model_t model{programs, island_model_t::config_t().set_migration_interval(5).set_migrants(10)};
+
+        const auto start = std::chrono::steady_clock::now();
+        model.run();
+        const auto total = seconds_since(start);
+        std::cout << threads << " threads, " << islands << " islands: " << total << "s, speedup " << single_thread_time / total
+            << "x, best fitness " << model.get_island(model.get_best_island()).get_population_stats().best_fitness << "\n";
+    }
+
+    std::cout << "\nSmall population generations\n";
+    for (const auto threads : counts)
+    {
+        const auto config = prog_config_t()
+                            .set_elite_count(2)
+                            .set_max_generations(30)
+                            .set_pop_size(500)
+                            .set_thread_count(threads);
+        example::symbolic_regression_t regression{SEED_FUNC, config};
+        regression.setup_operations();
+        regression.generate_initial_population();
+        auto& program = regression.get_program();
+
+        program.get_barrier().reset_wait_times();
+        size_t parks = 0;
+        const auto start = std::chrono::steady_clock::now();
+        while (!program.should_terminate())
+        {
+            program.create_next_generation();
+            program.next_generation();
+            program.evaluate_fitness();
+        }
+        const auto generations = static_cast<double>(program.get_current_generation());
+        for (size_t i = 0; i < program.get_barrier().get_thread_count(); i++)
+            parks += program.get_barrier().get_parks(i);
+        // the worker threads also wait on the barrier between generations, while the main thread is outside of the execution service
+        std::cout << threads << " threads: " << seconds_since(start) / generations * 1000 << "ms per generation, barrier wait "
+            << program.get_barrier().get_total_wait_time() / static_cast<double>(threads) / generations * 1000 << "ms per thread per generation, "
+            << parks << " waits parked\n";
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/program.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// runs the multi-threaded steady state replacement with most of the population replaced every generation, so the threads constantly
+// fight over the same victims. afterward every stored fitness must belong to its tree and the statistics and ranking must match.
+// meant to be run under thread sanitizer as well.
+
+using namespace blt::gp;
+
+const auto config = prog_config_t()
+                    .set_initial_min_tree_size(2)
+                    .set_initial_max_tree_size(6)
+                    .set_max_generations(20)
+                    .set_pop_size(500)
+                    .set_thread_count(8);
+
+static constexpr size_t REPLACEMENT_AMOUNT = 450;
+
+void verify(example::symbolic_regression_t& regression)
+{
+    auto& program = regression.get_program();
+    auto& pop = program.get_current_pop();
+    const auto& fitness = pop.get_adjusted_fitness();
+    for (size_t i = 0; i < fitness.size(); i++)
+    {
+        fitness_t fit{};
+        regression.get_fitness_function()(pop.get_individuals()[i].tree, fit, i);
+        if (fit.adjusted_fitness != fitness[i])
+        {
+            BLT_ERROR("Individual {} has a fitness of {} but its tree evaluates to {}!", i, fitness[i], fit.adjusted_fitness);
+            std::exit(1);
+        }
+    }
+
+    // tournament selection does not need the whole population ranked, only the best individual is
+    const auto& ranking = pop.get_ranking();
+    if (ranking.empty() || fitness[ranking.front()] != *std::max_element(fitness.begin(), fitness.end()))
+    {
+        BLT_ERROR("Population ranking does not start with the best individual!");
+        std::exit(1);
+    }
+    for (size_t i = 1; i < ranking.size(); i++)
+    {
+        if (fitness[ranking[i - 1]] < fitness[ranking[i]])
+        {
+            BLT_ERROR("Population ranking is out of order at {}!", i);
+            std::exit(1);
+        }
+    }
+
+    const auto& stats = program.get_population_stats();
+    double overall = 0;
+    for (const auto v : fitness)
+        overall += v;
+    if (std::abs(stats.overall_fitness - overall) > 1e-6 * std::abs(overall) + 1e-9)
+    {
+        BLT_ERROR("Overall fitness is {} but the population sums to {}!", stats.overall_fitness.load(), overall);
+        std::exit(1);
+    }
+    if (stats.worst_fitness != *std::min_element(fitness.begin(), fitness.end()) ||
+        stats.best_fitness != *std::max_element(fitness.begin(), fitness.end()))
+    {
+        BLT_ERROR("Best or worst fitness does not match the population!");
+        std::exit(1);
+    }
+}
+
+int main()
+{
+    example::symbolic_regression_t regression{691ul, config};
+    regression.setup_operations();
+    auto& program = regression.get_program();
+    program.generate_initial_population(program.get_typesystem().get_type<float>().id());
+
+    select_tournament_t tournament;
+    program.setup_steady_state_evaluation(regression.get_fitness_function(), tournament, REPLACEMENT_AMOUNT, tournament, tournament,
+                                          tournament);
+    verify(regression);
+    while (!program.should_terminate())
+    {
+        program.create_next_generation();
+        program.next_generation();
+        program.evaluate_fitness();
+        verify(regression);
+    }
+    BLT_INFO("Steady state replacement passed after {} generations", program.get_current_generation());
+}
@@ -0,0 +1,126 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <blt/gp/program.h>
+#include <blt/gp/subtree_pool.h>
+#include <blt/logging/logging.h>
+#include <cstdlib>
+#include <memory>
+
+// fills a subtree pool and draws from it under every reuse policy, checking the trees handed out and the hit, miss and generated counters.
+
+using namespace blt::gp;
+
+constexpr size_t TREES_PER_BUCKET = 8;
+constexpr size_t MAX_USES = 3;
+
+const auto config = prog_config_t()
+                    .set_initial_min_tree_size(2)
+                    .set_initial_max_tree_size(6)
+                    .set_pop_size(50)
+                    .set_thread_count(1);
+
+void expect(const bool condition, const char* message)
+{
+    if (!condition)
+    {
+        BLT_ERROR("Subtree pool test failed: {}", message);
+        std::exit(1);
+    }
+}
+
+void expect_stats(const subtree_pool_t& pool, const blt::u64 hits, const blt::u64 misses, const blt::u64 generated)
+{
+    const auto stats = pool.get_stats();
+    if (stats.hits != hits || stats.misses != misses || stats.trees_generated != generated)
+    {
+        BLT_ERROR("Expected {} hits, {} misses and {} trees generated, got {}, {} and {}", hits, misses, generated, stats.hits, stats.misses,
+                  stats.trees_generated);
+        std::exit(1);
+    }
+}
+
+void test_policy(const subtree_pool_t::reuse_policy_t policy, const size_t hands_out)
+{
+    subtree_pool_t pool{
+        subtree_pool_t::config_t{}.set_trees_per_bucket(TREES_PER_BUCKET).set_max_uses(MAX_USES).set_reuse_policy(policy).add_depth_range(3, 5)
+    };
+    example::symbolic_regression_t regression{691ul, prog_config_t{config}.set_subtree_pool(pool)};
+    regression.setup_operations();
+    auto& program = regression.get_program();
+    const auto type = program.get_typesystem().get_type<float>().id();
+
+    // the pool is empty until it is refilled
+    expect(pool.acquire(program, type, 2, 6) == nullptr, "empty pool handed out a tree");
+    expect_stats(pool, 0, 1, 0);
+
+    pool.begin_refill(program);
+    pool.refill(program);
+    expect(pool.get_owner() == &program, "pool is not owned by the program which refilled it");
+    // only float has operators, and there is one bucket per depth range
+    expect_stats(pool, 0, 1, 2 * TREES_PER_BUCKET);
+
+    for (size_t i = 0; i < hands_out; i++)
+    {
+        const auto* tree = pool.acquire(program, type, 3, 5);
+        expect(tree != nullptr, "pool missed before its bucket was exhausted");
+        const auto depth = tree->get_depth(program);
+        expect(depth >= 3 && depth <= 5, "pooled tree is outside of its bucket's depth range");
+    }
+    expect_stats(pool, hands_out, 1, 2 * TREES_PER_BUCKET);
+    if (policy != subtree_pool_t::reuse_policy_t::RANDOM)
+    {
+        expect(pool.acquire(program, type, 3, 5) == nullptr, "exhausted bucket handed out a tree");
+        expect_stats(pool, hands_out, 2, 2 * TREES_PER_BUCKET);
+    }
+    // depth ranges are matched exactly, and types without a bucket always miss
+    expect(pool.acquire(program, type, 3, 6) == nullptr, "pool handed out a tree for a depth range it does not have");
+    expect(pool.acquire(program, type_id{99}, 2, 6) == nullptr, "pool handed out a tree for a type it does not have");
+
+    // only the trees which were handed out are generated again
+    pool.reset_stats();
+    pool.begin_refill(program);
+    pool.refill(program);
+    expect_stats(pool, 0, 0, std::min(hands_out, TREES_PER_BUCKET));
+    expect(pool.acquire(program, type, 3, 5) != nullptr, "refilled bucket missed");
+}
+
+int main()
+{
+    test_policy(subtree_pool_t::reuse_policy_t::CONSUME, TREES_PER_BUCKET);
+    test_policy(subtree_pool_t::reuse_policy_t::CYCLE, TREES_PER_BUCKET * MAX_USES);
+    test_policy(subtree_pool_t::reuse_policy_t::RANDOM, TREES_PER_BUCKET * 4);
+
+    // a second program built from the same config must not empty the pool of the first when it is destroyed
+    subtree_pool_t pool{subtree_pool_t::config_t{}.set_trees_per_bucket(TREES_PER_BUCKET)};
+    const auto shared_config = prog_config_t{config}.set_subtree_pool(pool);
+    example::symbolic_regression_t owner{691ul, shared_config};
+    owner.setup_operations();
+    auto& program = owner.get_program();
+    const auto type = program.get_typesystem().get_type<float>().id();
+    pool.begin_refill(program);
+    pool.refill(program);
+    {
+        const auto other = std::make_unique<example::symbolic_regression_t>(692ul, shared_config);
+        other->setup_operations();
+    }
+    expect(pool.get_owner() == &program, "destroying another program released the pool");
+    expect(pool.acquire(program, type, 2, 6) != nullptr, "destroying another program emptied the pool");
+
+    BLT_INFO("Subtree pool tests passed");
+}
@@ -91,9 +91,9 @@ void run(const blt::gp::prog_config_t& config)
 
     const auto best = program.get_best_individuals<1>();
 
-    if (best[0].get().fitness.adjusted_fitness > best_fitness)
+    if (best[0].fitness.adjusted_fitness > best_fitness)
     {
-        best_fitness = best[0].get().fitness.adjusted_fitness;
+        best_fitness = best[0].fitness.adjusted_fitness;
         best_config = config;
     }
 }
@@ -0,0 +1,175 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "../examples/symbolic_regression.h"
+#include <chrono>
+#include <iostream>
+
+// measures the raw throughput of generating, copying, traversing and evaluating trees, single threaded, outside of the generational loop,
+// then the evaluation and selection sweeps of the generational loop itself. the seed is fixed so every build does the same work.
+
+using namespace blt::gp;
+
+constexpr size_t TREE_COUNT = 5000;
+constexpr size_t COPY_ROUNDS = 20;
+constexpr size_t EVAL_ROUNDS = 2;
+constexpr size_t SWEEP_GENERATIONS = 10;
+
+double seconds_since(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    example::symbolic_regression_t regression{691ul, prog_config_t().set_thread_count(1)};
+    regression.setup_operations();
+    auto& program = regression.get_program();
+    const auto& training_cases = regression.get_training_cases();
+
+    grow_generator_t generator;
+    const generator_arguments args{program, program.get_typesystem().get_type<float>().id(), 3, 10};
+    tracked_vector<tree_t> source;
+    tracked_vector<tree_t> destination;
+    size_t total_nodes = 0;
+    size_t total_value_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TREE_COUNT; i++)
+    {
+        auto& tree = source.emplace_back(program);
+        generator.generate(tree, args);
+        total_nodes += tree.size();
+        total_value_bytes += tree.total_value_bytes();
+        destination.emplace_back(program);
+    }
+
+    auto time = seconds_since(start);
+
+    std::cout << "Node size: " << sizeof(op_container_t) << " bytes, " << TREE_COUNT << " trees with " << total_nodes << " nodes and "
+        << total_value_bytes << " value bytes\n";
+    std::cout << "Generate: " << time << "s, " << static_cast<double>(total_nodes) / time / 1e6 << "M nodes/s\n";
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < COPY_ROUNDS; round++)
+    {
+        for (size_t i = 0; i < TREE_COUNT; i++)
+            destination[(i + round) % TREE_COUNT].copy_fast(source[i]);
+    }
+    time = seconds_since(start);
+    std::cout << "Copy: " << time << "s, " << static_cast<double>(total_nodes * COPY_ROUNDS) / time / 1e6 << "M nodes/s\n";
+
+    // copies into freshly constructed trees, which have to allocate unless the tree fits inline
+    start = std::chrono::steady_clock::now();
+    size_t inline_trees = 0;
+    for (size_t round = 0; round < COPY_ROUNDS; round++)
+    {
+        tracked_vector<tree_t> copies;
+        copies.reserve(TREE_COUNT);
+        for (const auto& tree : source)
+            copies.emplace_back(tree);
+        inline_trees = 0;
+        for (const auto& tree : copies)
+            inline_trees += tree.is_inline();
+    }
+    time = seconds_since(start);
+    std::cout << "Copy (new trees): " << time << "s, " << static_cast<double>(total_nodes * COPY_ROUNDS) / time / 1e6 << "M nodes/s, "
+        << inline_trees << " stored inline, tree size " << sizeof(tree_t) << " bytes\n";
+
+    // same as above, but rebuilding every tree from an arena each round like an arena backed population does
+    tree_arena_t arena;
+    tracked_vector<tree_t> arena_destination;
+    for (size_t i = 0; i < TREE_COUNT; i++)
+        arena_destination.emplace_back(program, &arena);
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < COPY_ROUNDS; round++)
+    {
+        for (auto& tree : arena_destination)
+            tree.clear_storage();
+        arena.reset();
+        for (size_t i = 0; i < TREE_COUNT; i++)
+            arena_destination[(i + round) % TREE_COUNT].copy_fast(source[i]);
+    }
+    time = seconds_since(start);
+    std::cout << "Copy (arena): " << time << "s, " << static_cast<double>(total_nodes * COPY_ROUNDS) / time / 1e6 << "M nodes/s, "
+        << arena.bytes_reserved() / 1024 << "KiB reserved\n";
+
+    start = std::chrono::steady_clock::now();
+    size_t depth_sum = 0;
+    for (size_t round = 0; round < COPY_ROUNDS; round++)
+    {
+        for (const auto& tree : source)
+        {
+            depth_sum += tree.get_depth(program);
+            const auto point = tree.select_subtree();
+            depth_sum += static_cast<size_t>(tree.find_endpoint(point.pos) - point.pos);
+        }
+    }
+    time = seconds_since(start);
+    std::cout << "Structure: " << time << "s, " << static_cast<double>(total_nodes * COPY_ROUNDS) / time / 1e6 << "M nodes/s (checksum "
+        << depth_sum << ")\n";
+
+    start = std::chrono::steady_clock::now();
+    double sum = 0;
+    for (size_t round = 0; round < EVAL_ROUNDS; round++)
+    {
+        for (const auto& tree : source)
+        {
+            for (const auto& fitness_case : training_cases)
+            {
+                const auto value = tree.get_evaluation_value<float>(fitness_case);
+                if (std::isfinite(value))
+                    sum += value;
+            }
+        }
+    }
+    time = seconds_since(start);
+    const auto evaluated_nodes = static_cast<double>(total_nodes * EVAL_ROUNDS * training_cases.size());
+    std::cout << "Evaluate: " << time << "s, " << evaluated_nodes / time / 1e6 << "M nodes/s (checksum " << sum << ")\n";
+
+    // the generational loop walks the whole population for evaluation and selection, so it is sensitive to the size of the tree object
+    // itself. the example draws its ephemeral constants from the first program's random engine, which is also seeded, so the work is
+    // repeatable.
+    const auto sweep_config = prog_config_t().set_pop_size(TREE_COUNT).set_max_generations(SWEEP_GENERATIONS).set_initial_min_tree_size(2).
+                                              set_initial_max_tree_size(6).set_thread_count(1);
+    example::symbolic_regression_t sweep{691ul, sweep_config};
+    sweep.setup_operations();
+    sweep.generate_initial_population();
+    auto& sweep_program = sweep.get_program();
+    double selection_time = 0;
+    double evaluation_time = 0;
+    size_t sweep_nodes = 0;
+    size_t sweep_inline = 0;
+    while (!sweep_program.should_terminate())
+    {
+        start = std::chrono::steady_clock::now();
+        sweep_program.create_next_generation();
+        sweep_program.next_generation();
+        selection_time += seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        sweep_program.evaluate_fitness();
+        evaluation_time += seconds_since(start);
+        for (const auto& ind : sweep_program.get_current_pop().get_individuals())
+        {
+            sweep_nodes += ind.tree.size();
+            sweep_inline += ind.tree.is_inline();
+        }
+    }
+    std::cout << "Sweep: selection " << selection_time << "s, evaluation " << evaluation_time << "s over " << SWEEP_GENERATIONS
+        << " generations, " << static_cast<double>(sweep_nodes) / static_cast<double>(TREE_COUNT * SWEEP_GENERATIONS) << " nodes per tree, "
+        << static_cast<double>(sweep_inline) / static_cast<double>(TREE_COUNT * SWEEP_GENERATIONS) * 100 << "% stored inline (best fitness "
+        << sweep_program.get_population_stats().best_fitness.load() << ")\n";
+}